@@ -0,0 +1,189 @@
+// batch_eval.hpp  (header-only, link with -lpthread)
+//
+// Scores many candidate points against one model with a single pass over
+// the matrix per batch: the activities of all K candidates of a batch come
+// from one SpMM (spmv.hpp), so A is streamed once instead of K times and
+// the x gathers turn into K-wide vector loads. Per candidate the result is
+// the objective c.x, the total row violation and the number of rows
+// violated by more than tol (the measures of check_violation).
+//
+//   BatchEval E; E.init(P);
+//   E.evaluate(X, K, score);                // X[j*K+k]: column j of candidate k
+//   random_roundings(P, xlp, K, seed, 0, X);
+//   std::vector<Candidate> c=E.best_roundings(xlp, K, keep, seed);
+//
+// best_roundings draws K roundings of an LP point in batches of `block`
+// (fewer when n+m is large, to bound the buffers), scores them and keeps
+// the `keep` best: feasible ones by objective first, then the rest by
+// total violation. They are starting points for repair / local search.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "mip_problem.hpp"
+#include "spmv.hpp"
+
+struct CandidateScore {
+    double obj=0;                   // c.x (no offset)
+    double viol=0;                  // sum of row violations
+    int violated=0;                 // rows off by more than tol
+
+    bool feasible() const { return violated==0; }
+};
+
+// feasible before infeasible; then objective, or violation and objective
+inline bool better_candidate(const CandidateScore& a, const CandidateScore& b){
+    if(a.feasible()!=b.feasible()) return a.feasible();
+    if(a.feasible()) return a.obj<b.obj;
+    return a.viol!=b.viol ? a.viol<b.viol : a.obj<b.obj;
+}
+
+struct Candidate {
+    std::vector<double> x;
+    CandidateScore score;
+};
+
+// uniform in [0, 1) from a splitmix64 hash of (seed, id, j)
+inline double rounding_uniform(uint64_t seed, uint64_t id, uint64_t j){
+    uint64_t z=seed+id*0x9E3779B97F4A7C15ull+j*0xD1B54A32D192ED03ull;
+    z=(z^(z>>30))*0xBF58476D1CE4E5B9ull;
+    z=(z^(z>>27))*0x94D049BB133111EBull;
+    z^=z>>31;
+    return (double)(z>>11)*(1.0/9007199254740992.0);
+}
+
+// Candidates id0 .. id0+K-1 of a rounding sequence into X[j*K+k], every
+// one depending on (seed, id) only. Integer columns: id 0 rounds at 0.5,
+// even ids at one threshold in [0.1, 0.9] for all columns, odd ids at a
+// fresh uniform threshold per column (randomized rounding). Continuous
+// columns keep the LP value. Everything is clamped into the bounds.
+inline void random_roundings(const MipView& P, const std::vector<double>& xlp, int K, uint64_t seed,
+                             int64_t id0, std::vector<double>& X){
+    X.resize((size_t)P.n*K);
+    std::vector<double> t(K);
+    for(int k=0;k<K;k++){
+        uint64_t id=(uint64_t)(id0+k);
+        t[k]= id==0 ? 0.5 : 0.1+0.8*rounding_uniform(seed,id,~0ull);
+    }
+    for(int j=0;j<P.n;j++){
+        double l=P.lb[j], u=P.ub[j], v=std::min(std::max(xlp[j],l),u);
+        double* xj=&X[(size_t)j*K];
+        if(!P.is_int[j]){
+            for(int k=0;k<K;k++) xj[k]=v;
+            continue;
+        }
+        if(l>-MIP_INF) l=std::ceil(l-1e-9);
+        if(u<MIP_INF) u=std::floor(u+1e-9);
+        double f=std::floor(v), frac=v-f;
+        for(int k=0;k<K;k++){
+            uint64_t id=(uint64_t)(id0+k);
+            double th= id&1 ? rounding_uniform(seed,id,j) : t[k];
+            double r= frac>=th ? f+1 : f;
+            xj[k]=std::min(std::max(r,l),u);
+        }
+    }
+}
+
+class BatchEval {
+public:
+    double tol=1e-8;                // row feasibility tolerance (as check_violation)
+    int block=32;                   // candidates per SpMM in best_roundings
+
+    // last best_roundings call
+    int64_t evaluated=0, feasible=0;
+
+    void init(const MipView& p){
+        P=&p;
+        A.build(p);
+    }
+
+    // Rows are cut into nnz-balanced parts, one per thread, and each part
+    // into tiles of about 64 KB of activities that are reduced while still
+    // in cache; all m x K activities never exist at once.
+    void evaluate(const std::vector<double>& X, int K, std::vector<CandidateScore>& out, int threads=0){
+        const MipView& p=*P;
+        if(threads<=0) threads=(int)std::min<int64_t>(std::max(1u,std::thread::hardware_concurrency()),
+                                                      (int64_t)p.nnz*K/65536+1);
+        int T=std::max(16,8192/std::max(1,K));
+        std::vector<int> b=spmv::detail::split(p.rp,p.m,threads);
+        std::vector<std::vector<double>> part(threads);
+        spmv::detail::parallel(threads,[&](int t){
+            std::vector<double> Y((size_t)T*K), acc(2*(size_t)K,0.0);
+            double *v=acc.data(), *c=v+K;
+            for(int r0=b[t];r0<b[t+1];r0+=T){
+                int r1=std::min(b[t+1],r0+T);
+                A.multiply_rows(X.data(),K,r0,r1,Y.data());
+                for(int r=r0;r<r1;r++){
+                    double lo=p.rlo[r], hi=p.rhi[r], lt=lo-tol, ht=hi+tol;
+                    const double* yr=&Y[(size_t)(r-r0)*K];
+#pragma omp simd
+                    for(int k=0;k<K;k++){
+                        double a=yr[k];
+                        double u=a-hi, w=lo-a;
+                        u= u>w ? u : w;
+                        v[k]+= u>0 ? u : 0.0;
+                        c[k]+= (double)(a>ht)+(double)(a<lt);   // lo <= hi: at most one
+                    }
+                }
+            }
+            part[t].swap(acc);
+        });
+        std::vector<double> obj(K,0.0);
+        double* o=obj.data();
+        for(int j=0;j<p.n;j++){
+            double cj=p.obj[j];
+            if(cj==0) continue;
+            const double* xj=&X[(size_t)j*K];
+#pragma omp simd
+            for(int k=0;k<K;k++) o[k]+=cj*xj[k];
+        }
+        out.assign(K,CandidateScore());
+        for(int k=0;k<K;k++){
+            double v=0, c=0;
+            out[k].obj=o[k];
+            for(const std::vector<double>& q:part){ v+=q[k]; c+=q[K+k]; }
+            out[k].viol=v; out[k].violated=(int)c;
+        }
+    }
+
+    std::vector<Candidate> best_roundings(const std::vector<double>& xlp, int K, int keep, uint64_t seed,
+                                          int threads=0){
+        const MipView& p=*P;
+        // X and Y of a batch within about 128 MB
+        int B=(int)std::max<int64_t>(1,std::min<int64_t>(block,((int64_t)1<<24)/std::max(1,p.n+p.m)));
+        keep=std::max(1,keep);
+        evaluated=feasible=0;
+        std::vector<Candidate> best;
+        std::vector<CandidateScore> sc;
+        for(int64_t id=0;id<K;id+=B){
+            int b=(int)std::min<int64_t>(B,K-id);
+            random_roundings(p,xlp,b,seed,id,X);
+            evaluate(X,b,sc,threads);
+            for(int k=0;k<b;k++){
+                evaluated++;
+                feasible+=sc[k].feasible();
+                if((int)best.size()>=keep && !better_candidate(sc[k],best.back().score)) continue;
+                Candidate c;
+                c.score=sc[k];
+                c.x.resize(p.n);
+                for(int j=0;j<p.n;j++) c.x[j]=X[(size_t)j*b+k];
+                auto at=std::upper_bound(best.begin(),best.end(),c,
+                                         [](const Candidate& u,const Candidate& v){ return better_candidate(u.score,v.score); });
+                best.insert(at,std::move(c));
+                if((int)best.size()>keep) best.pop_back();
+            }
+        }
+        return best;
+    }
+
+private:
+    const MipView* P=nullptr;
+    spmv::Matrix A;
+    std::vector<double> X;
+};
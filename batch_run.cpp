@@ -0,0 +1,575 @@
+// batch_run.cpp  (NO CMAKE REQUIRED)
+//
+// Parallel batch driver for instance x solver x parameter sweeps, in place
+// of the serial loops in run_all.sh / src/cuopt_pdlp_script.sh.
+//
+// Compile:
+// g++ -std=c++17 -O2 batch_run.cpp -o batch_run -lz -lpthread
+//
+// Usage:
+// ./batch_run batch.manifest [jobs=N] [retry] [list]
+//
+// Manifest (one directive per line, # starts a comment):
+//   instance  test_set/instances/instance_*.mps.gz     (glob, repeatable)
+//   solver    pdlp    ./mps_solver {mipc} {out}.sol
+//   solver    fp2opt  ./fp2opt {inst} {name} {time} engine=cpu
+//   param     time    60 300
+//   set jobs 8          concurrent jobs           (default: cores)
+//   set wall 600        seconds per job, 0 = none (SIGTERM, SIGKILL 5 s later)
+//   set mem  16G        resident memory per job (all its processes), 0 = none
+//   gpu      pdlp       solvers that use the GPU              (repeatable)
+//   set gpu_jobs 1      concurrent jobs of those solvers      (default 1)
+//   set out  batch_out  journal, logs and {out} prefixes
+//   set lookahead 4     instances prepared ahead of the running ones
+//
+// Placeholders in solver commands:
+//   {inst} path as listed   {name} instance_01   {id} 01
+//   {mps}  uncompressed .mps next to the .gz (decompressed on demand)
+//   {mipc} binary cache (mip_cache.hpp, built on demand)
+//   {out}  <out>/<solver>/<name>[_param=value...]   {<param>} its value
+// A solver runs once per combination of the params its command uses.
+//
+// A prefetch thread prepares the {mps}/{mipc} files of upcoming instances
+// while earlier jobs run. Every finished job is appended to
+// <out>/journal.tsv; on restart, jobs already in the journal are skipped
+// (with "retry", only those that ended "ok"). Ctrl-C stops the sweep and
+// kills running jobs, which then run again on the next start.
+//
+// The memory limit is checked by polling the summed RSS of the job's
+// process group and killing it past the limit (status "memory"); an
+// address-space rlimit would break every job that creates a CUDA context,
+// which reserves far more virtual memory than it uses.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <glob.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "mip_cache.hpp"
+
+namespace fs = std::filesystem;
+
+// -------- MANIFEST ----------
+
+struct Solver {
+    std::string name, cmd;
+    std::vector<std::string> params;        // referenced params, manifest order
+    bool gpu=false;
+};
+
+struct Manifest {
+    std::vector<std::string> instances;
+    std::vector<Solver> solvers;
+    std::vector<std::pair<std::string,std::vector<std::string>>> params;
+    int jobs=0;
+    double wall=0;
+    long long mem=0;
+    int gpu_jobs=1;
+    std::vector<std::string> gpu;
+    std::string out="batch_out";
+    int lookahead=4;
+};
+
+static long long parse_size(const std::string& s){
+    char* e=nullptr;
+    double v=strtod(s.c_str(),&e);
+    switch(e && *e ? toupper(*e) : 0){
+        case 'K': v*=1024.0; break;
+        case 'M': v*=1024.0*1024; break;
+        case 'G': v*=1024.0*1024*1024; break;
+        case 'T': v*=1024.0*1024*1024*1024; break;
+    }
+    return (long long)v;
+}
+
+static bool read_manifest(const std::string& path, Manifest& M, std::string& err){
+    std::ifstream f(path);
+    if(!f){ err="cannot open "+path; return false; }
+    std::string line;
+    int ln=0;
+    while(std::getline(f,line)){
+        ln++;
+        size_t h=line.find('#');
+        if(h!=std::string::npos) line.resize(h);
+        std::istringstream is(line);
+        std::string kw;
+        if(!(is>>kw)) continue;
+        auto bad=[&](const std::string& m){ err=path+":"+std::to_string(ln)+": "+m; return false; };
+        if(kw=="instance"){
+            std::string pat;
+            while(is>>pat){
+                glob_t g;
+                if(glob(pat.c_str(),0,nullptr,&g)==0)
+                    for(size_t k=0;k<g.gl_pathc;k++) M.instances.push_back(g.gl_pathv[k]);
+                else if(fs::exists(pat)) M.instances.push_back(pat);
+                else fprintf(stderr,"warning: %s matches nothing\n",pat.c_str());
+                globfree(&g);
+            }
+        } else if(kw=="solver"){
+            Solver s;
+            if(!(is>>s.name)) return bad("solver needs a name");
+            std::getline(is,s.cmd);
+            s.cmd.erase(0,s.cmd.find_first_not_of(" \t"));
+            if(s.cmd.empty()) return bad("solver "+s.name+" has no command");
+            M.solvers.push_back(s);
+        } else if(kw=="gpu"){
+            std::string name;
+            while(is>>name) M.gpu.push_back(name);
+        } else if(kw=="param"){
+            std::string name, v;
+            if(!(is>>name)) return bad("param needs a name");
+            std::vector<std::string> vals;
+            while(is>>v) vals.push_back(v);
+            if(vals.empty()) return bad("param "+name+" has no values");
+            M.params.push_back({name,vals});
+        } else if(kw=="set"){
+            std::string k, v;
+            if(!(is>>k>>v)) return bad("set needs a key and a value");
+            if(k=="jobs") M.jobs=atoi(v.c_str());
+            else if(k=="wall") M.wall=atof(v.c_str());
+            else if(k=="mem") M.mem=parse_size(v);
+            else if(k=="gpu_jobs") M.gpu_jobs=std::max(1,atoi(v.c_str()));
+            else if(k=="out") M.out=v;
+            else if(k=="lookahead") M.lookahead=std::max(1,atoi(v.c_str()));
+            else return bad("unknown setting "+k);
+        } else return bad("unknown directive "+kw);
+    }
+    for(const std::string& g:M.gpu){
+        auto it=std::find_if(M.solvers.begin(),M.solvers.end(),[&](const Solver& s){ return s.name==g; });
+        if(it==M.solvers.end()){ err=path+": gpu names unknown solver "+g; return false; }
+        it->gpu=true;
+    }
+    for(auto& s:M.solvers)
+        for(auto& p:M.params)
+            if(s.cmd.find("{"+p.first+"}")!=std::string::npos) s.params.push_back(p.first);
+    return true;
+}
+
+// -------- JOBS ----------
+
+struct Job {
+    int inst=0;                 // index into the instance list
+    const Solver* solver=nullptr;
+    std::vector<std::pair<std::string,std::string>> vals;
+    std::string key;            // solver/name[/param=value...]
+};
+
+static std::string inst_name(const std::string& path){
+    std::string b=fs::path(path).filename().string();
+    for(const char* ext:{".gz",".mps",".mipc"})
+        if(b.size()>strlen(ext) && b.compare(b.size()-strlen(ext),std::string::npos,ext)==0)
+            b.resize(b.size()-strlen(ext));
+    return b;
+}
+
+static std::string inst_id(const std::string& name){
+    size_t k=name.size();
+    while(k>0 && isdigit((unsigned char)name[k-1])) k--;
+    return name.substr(k);
+}
+
+static std::string mps_path(const std::string& inst){
+    std::string p=inst;
+    if(mps_detail::ends_with(p,".gz")) p.resize(p.size()-3);
+    return p;
+}
+
+static std::vector<Job> expand(const Manifest& M){
+    std::map<std::string,const std::vector<std::string>*> pv;
+    for(auto& p:M.params) pv[p.first]=&p.second;
+    std::vector<Job> jobs;
+    for(int i=0;i<(int)M.instances.size();i++){
+        std::string name=inst_name(M.instances[i]);
+        for(const Solver& s:M.solvers){
+            // odometer over the referenced params
+            std::vector<size_t> at(s.params.size(),0);
+            while(true){
+                Job j;
+                j.inst=i; j.solver=&s;
+                j.key=s.name+"/"+name;
+                for(size_t k=0;k<s.params.size();k++){
+                    const std::string& v=(*pv[s.params[k]])[at[k]];
+                    j.vals.push_back({s.params[k],v});
+                    j.key+="/"+s.params[k]+"="+v;
+                }
+                jobs.push_back(j);
+                size_t k=0;
+                while(k<at.size() && ++at[k]==pv[s.params[k]]->size()){ at[k]=0; k++; }
+                if(k==at.size()) break;
+            }
+        }
+    }
+    return jobs;
+}
+
+static std::string substitute(const std::string& cmd, const std::map<std::string,std::string>& vars){
+    std::string r;
+    for(size_t k=0;k<cmd.size();){
+        if(cmd[k]=='{'){
+            size_t e=cmd.find('}',k);
+            if(e!=std::string::npos){
+                auto it=vars.find(cmd.substr(k+1,e-k-1));
+                if(it!=vars.end()){ r+=it->second; k=e+1; continue; }
+            }
+        }
+        r+=cmd[k++];
+    }
+    return r;
+}
+
+// -------- PREFETCH ----------
+// Prepares {mps} / {mipc} files instance by instance, at most `lookahead`
+// instances ahead of the oldest instance that still has jobs to start.
+
+class Prefetcher {
+public:
+    Prefetcher(const Manifest& M, bool need_mps, bool need_mipc)
+        : M_(M), need_mps_(need_mps), need_mipc_(need_mipc),
+          ready_(M.instances.size(),0) {
+        th_=std::thread(&Prefetcher::loop,this);
+    }
+    ~Prefetcher(){
+        { std::lock_guard<std::mutex> g(mu_); stop_=true; }
+        cv_.notify_all();
+        th_.join();
+    }
+
+    // blocks until instance i is prepared; also moves the window forward
+    void wait(int i){
+        std::unique_lock<std::mutex> g(mu_);
+        if(i>front_){ front_=i; cv_.notify_all(); }
+        cv_.wait(g,[&]{ return ready_[i] || stop_; });
+    }
+
+private:
+    static bool gunzip(const std::string& gz, const std::string& out){
+        gzFile in=gzopen(gz.c_str(),"rb");
+        if(!in) return false;
+        gzbuffer(in,1<<17);
+        std::string tmp=out+".tmp";
+        FILE* f=fopen(tmp.c_str(),"wb");
+        if(!f){ gzclose(in); return false; }
+        std::vector<char> buf(1<<20);
+        int got;
+        bool ok=true;
+        while((got=gzread(in,buf.data(),(unsigned)buf.size()))>0)
+            ok&=fwrite(buf.data(),1,(size_t)got,f)==(size_t)got;
+        ok&=got==0;
+        gzclose(in);
+        ok&=fclose(f)==0;
+        if(ok) ok=rename(tmp.c_str(),out.c_str())==0;
+        if(!ok) remove(tmp.c_str());
+        return ok;
+    }
+
+    static bool stale(const std::string& derived, const std::string& src){
+        std::error_code ec;
+        if(!fs::exists(derived,ec)) return true;
+        return fs::last_write_time(src,ec)>fs::last_write_time(derived,ec);
+    }
+
+    static void readahead(const std::string& p){
+        int fd=open(p.c_str(),O_RDONLY);
+        if(fd<0) return;
+        posix_fadvise(fd,0,0,POSIX_FADV_WILLNEED);
+        close(fd);
+    }
+
+    void prepare(const std::string& inst){
+        std::string mps=mps_path(inst);
+        if(need_mps_ && mps!=inst && stale(mps,inst)){
+            if(!gunzip(inst,mps)) fprintf(stderr,"prefetch: cannot decompress %s\n",inst.c_str());
+        }
+        if(need_mps_) readahead(mps);
+        if(need_mipc_ && !mps_detail::ends_with(inst,".mipc")){
+            std::string mipc=mip_cache_path(inst);
+            if(stale(mipc,inst)){
+                MipProblem P; std::string err;
+                if(!read_mps(inst,P,&err) || !write_mip_cache(mipc,P))
+                    fprintf(stderr,"prefetch: cannot build %s: %s\n",mipc.c_str(),err.c_str());
+            }
+            readahead(mipc);
+        }
+    }
+
+    void loop(){
+        for(int i=0;i<(int)ready_.size();i++){
+            {
+                std::unique_lock<std::mutex> g(mu_);
+                cv_.wait(g,[&]{ return stop_ || i<front_+M_.lookahead; });
+                if(stop_) return;
+            }
+            prepare(M_.instances[i]);
+            { std::lock_guard<std::mutex> g(mu_); ready_[i]=1; }
+            cv_.notify_all();
+        }
+    }
+
+    const Manifest& M_;
+    bool need_mps_, need_mipc_;
+    std::vector<char> ready_;
+    int front_=0;
+    bool stop_=false;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::thread th_;
+};
+
+// -------- JOURNAL ----------
+// <out>/journal.tsv: key status exit wall_s maxrss_kb log, one line per
+// finished job, written with a single append and fsync'd.
+
+class Journal {
+public:
+    bool open(const std::string& path){
+        std::ifstream in(path);
+        std::string line;
+        while(std::getline(in,line)){
+            if(line.empty() || line[0]=='#') continue;
+            size_t t1=line.find('\t'), t2=line.find('\t',t1+1);
+            if(t1==std::string::npos) continue;
+            status_[line.substr(0,t1)]=line.substr(t1+1,t2-t1-1);
+        }
+        bool fresh=!fs::exists(path);
+        fd_=::open(path.c_str(),O_WRONLY|O_CREAT|O_APPEND,0644);
+        if(fd_<0) return false;
+        if(fresh) put("# key\tstatus\texit\twall_s\tmaxrss_kb\tlog\n");
+        return true;
+    }
+    ~Journal(){ if(fd_>=0) close(fd_); }
+
+    // status recorded for key, "" if none
+    std::string status(const std::string& key) const {
+        auto it=status_.find(key);
+        return it==status_.end() ? "" : it->second;
+    }
+
+    void record(const std::string& key, const std::string& st, int code, double wall, long maxrss, const std::string& log){
+        char buf[64];
+        snprintf(buf,sizeof(buf),"\t%d\t%.3f\t%ld\t",code,wall,maxrss);
+        put(key+"\t"+st+buf+log+"\n");
+    }
+
+private:
+    void put(const std::string& s){
+        std::lock_guard<std::mutex> g(mu_);
+        if(write(fd_,s.data(),s.size())<0) perror("journal");
+        fsync(fd_);
+    }
+    std::map<std::string,std::string> status_;
+    int fd_=-1;
+    std::mutex mu_;
+};
+
+// -------- RUN ----------
+
+static std::atomic<bool> g_stop{false};
+static void on_signal(int){ g_stop=true; }
+
+struct Result { std::string status; int code=-1; double wall=0; long maxrss=0; };
+
+// summed resident memory of the processes in group pgid, bytes
+static long long group_rss(pid_t pgid){
+    static const long page=sysconf(_SC_PAGESIZE);
+    long long rss=0;
+    std::error_code ec;
+    for(const auto& e:fs::directory_iterator("/proc",ec)){
+        const std::string d=e.path().filename().string();
+        if(d.empty() || !isdigit((unsigned char)d[0])) continue;
+        std::ifstream f("/proc/"+d+"/stat");
+        std::string st;
+        if(!std::getline(f,st)) continue;
+        // fields after "(comm)": state ppid pgrp ... rss is field 24
+        size_t p=st.rfind(')');
+        if(p==std::string::npos) continue;
+        std::istringstream is(st.substr(p+2));
+        std::string tok;
+        long long v=0, grp=-1;
+        for(int k=3;k<=24 && is>>tok;k++){
+            if(k==5) grp=atoll(tok.c_str());
+            if(k==24) v=atoll(tok.c_str());
+        }
+        if(grp==pgid) rss+=v*page;
+    }
+    return rss;
+}
+
+static Result run_job(const std::string& cmd, const std::string& log, const Manifest& M){
+    Result R;
+    auto t0=std::chrono::steady_clock::now();
+    pid_t pid=fork();
+    if(pid<0){ R.status="error"; return R; }
+    if(pid==0){
+        setpgid(0,0);
+        int fd=open(log.c_str(),O_WRONLY|O_CREAT|O_TRUNC,0644);
+        if(fd>=0){ dup2(fd,1); dup2(fd,2); close(fd); }
+        execl("/bin/sh","sh","-c",cmd.c_str(),(char*)nullptr);
+        _exit(127);
+    }
+    setpgid(pid,pid);
+
+    int st=0;
+    struct rusage ru;
+    memset(&ru,0,sizeof(ru));
+    bool timed_out=false, killed=false, over_mem=false;
+    double term_at=-1, mem_at=0;
+    while(true){
+        pid_t r=wait4(pid,&st,WNOHANG,&ru);
+        if(r==pid) break;
+        if(r<0){ R.status="error"; return R; }
+        double t=std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+        bool over=M.wall>0 && t>M.wall;
+        if((over || g_stop) && term_at<0){
+            timed_out=over;
+            kill(-pid,SIGTERM);
+            term_at=t;
+        }
+        if(term_at>=0 && !killed && t>term_at+5){ kill(-pid,SIGKILL); killed=true; }
+        if(M.mem>0 && !killed && t>=mem_at){
+            mem_at=t+0.5;
+            if(group_rss(pid)>M.mem){ over_mem=true; kill(-pid,SIGKILL); killed=true; }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    R.wall=std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+    R.maxrss=ru.ru_maxrss;
+    if(WIFEXITED(st)){
+        R.code=WEXITSTATUS(st);
+        R.status = R.code==0 ? "ok" : "fail";
+    } else {
+        R.code=128+WTERMSIG(st);
+        R.status="signal";
+    }
+    if(over_mem) R.status="memory";
+    else if(timed_out) R.status="timeout";
+    else if(term_at>=0) R.status="stopped";
+    return R;
+}
+
+static std::string sanitize(std::string s){
+    for(char& c:s) if(c=='/' || c=='=' || c==' ') c='_';
+    return s;
+}
+
+int main(int argc,char** argv){
+    if(argc<2){
+        printf("usage: ./batch_run batch.manifest [jobs=N] [retry] [list]\n");
+        return 1;
+    }
+    Manifest M; std::string err;
+    if(!read_manifest(argv[1],M,err)){ fprintf(stderr,"%s\n",err.c_str()); return 1; }
+    bool retry=false, list=false;
+    for(int a=2;a<argc;a++){
+        std::string s=argv[a];
+        if(s.rfind("jobs=",0)==0) M.jobs=atoi(s.c_str()+5);
+        else if(s=="retry") retry=true;
+        else if(s=="list") list=true;
+        else { fprintf(stderr,"unknown argument %s\n",s.c_str()); return 1; }
+    }
+    if(M.jobs<=0) M.jobs=std::max(1u,std::thread::hardware_concurrency());
+
+    std::vector<Job> all=expand(M);
+    fs::create_directories(M.out+"/logs");
+    Journal J;
+    if(!J.open(M.out+"/journal.tsv")){ fprintf(stderr,"cannot open journal in %s\n",M.out.c_str()); return 1; }
+
+    std::vector<Job> todo;
+    for(const Job& j:all){
+        std::string st=J.status(j.key);
+        if(st.empty() || (retry && st!="ok")) todo.push_back(j);
+    }
+    printf("%zu instances, %zu solvers: %zu jobs, %zu already done, %d at a time\n",
+           M.instances.size(),M.solvers.size(),all.size(),all.size()-todo.size(),M.jobs);
+    if(list){
+        for(const Job& j:todo) printf("%s\n",j.key.c_str());
+        return 0;
+    }
+    if(todo.empty()) return 0;
+
+    bool need_mps=false, need_mipc=false;
+    for(const Solver& s:M.solvers){
+        need_mps|=s.cmd.find("{mps}")!=std::string::npos;
+        need_mipc|=s.cmd.find("{mipc}")!=std::string::npos;
+    }
+    Prefetcher pre(M,need_mps,need_mipc);
+
+    signal(SIGINT,on_signal);
+    signal(SIGTERM,on_signal);
+
+    std::atomic<size_t> next{0};
+    std::atomic<int> done{0}, failed{0};
+    std::mutex print_mu;
+    // GPU jobs share the device: at most gpu_jobs of them at a time
+    std::mutex gpu_mu;
+    std::condition_variable gpu_cv;
+    int gpu_free=M.gpu_jobs;
+    auto worker=[&]{
+        while(!g_stop){
+            size_t k=next++;
+            if(k>=todo.size()) return;
+            const Job& j=todo[k];
+            const std::string& inst=M.instances[j.inst];
+            pre.wait(j.inst);
+            if(g_stop) return;
+
+            std::map<std::string,std::string> vars;
+            std::string name=inst_name(inst);
+            vars["inst"]=inst;
+            vars["name"]=name;
+            vars["id"]=inst_id(name);
+            vars["mps"]=mps_path(inst);
+            vars["mipc"]=mps_detail::ends_with(inst,".mipc") ? inst : mip_cache_path(inst);
+            std::string out=M.out+"/"+j.solver->name+"/"+name;
+            for(auto& v:j.vals){ vars[v.first]=v.second; out+="_"+v.first+"="+v.second; }
+            fs::create_directories(M.out+"/"+j.solver->name);
+            vars["out"]=out;
+            vars["solver"]=j.solver->name;
+
+            std::string log=M.out+"/logs/"+sanitize(j.key)+".log";
+            if(j.solver->gpu){
+                std::unique_lock<std::mutex> g(gpu_mu);
+                gpu_cv.wait(g,[&]{ return gpu_free>0; });
+                gpu_free--;
+            }
+            Result R=run_job(substitute(j.solver->cmd,vars),log,M);
+            if(j.solver->gpu){
+                { std::lock_guard<std::mutex> g(gpu_mu); gpu_free++; }
+                gpu_cv.notify_one();
+            }
+            if(R.status=="stopped") return;     // not journaled: runs again on resume
+            J.record(j.key,R.status,R.code,R.wall,R.maxrss,log);
+            int d=++done;
+            if(R.status!="ok") failed++;
+            std::lock_guard<std::mutex> g(print_mu);
+            printf("[%d/%zu] %-8s %7.1fs %s\n",d,todo.size(),R.status.c_str(),R.wall,j.key.c_str());
+            fflush(stdout);
+        }
+    };
+    std::vector<std::thread> th;
+    for(int t=0;t<M.jobs;t++) th.emplace_back(worker);
+    for(auto& t:th) t.join();
+
+    printf("%d jobs finished, %d not ok%s\n",done.load(),failed.load(),
+           g_stop ? " (interrupted: run again to resume)" : "");
+    return g_stop ? 130 : 0;
+}
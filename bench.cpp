@@ -0,0 +1,515 @@
+// bench.cpp  (NO CMAKE REQUIRED)
+//
+// Primal-heuristic benchmark and kernel microbenchmarks, scored against the
+// best known values in obj.csv (bounds from instance_5m_bounds.txt).
+//
+// Compile:
+// g++ -std=c++17 -O2 -march=native -fopenmp-simd bench.cpp -o bench -lz -lpthread
+//
+// Usage:
+// ./bench heur    [inst=01,03,...] [heur=fp2opt,...] [time=60] [out=bench_results]
+// ./bench kernels [inst=01,03,...] [reps=5] [threads=N] [out=bench_results]
+//
+// heur runs every heuristic of HEURISTICS on every instance, one at a time,
+// then reads back the incumbents it wrote (.msol, with timestamps), checks
+// each against the model and records
+//   ttff            seconds from launch to the first feasible incumbent
+//   primal_integral integral of the primal gap over [0, time], gap 1 until
+//                   the first incumbent (Berthold), so lower is better
+//   final_gap       primal gap of the best incumbent to best_obj_value
+//   bound_gap       relative gap of the best incumbent to the best bound
+// and every incumbent over time.
+//
+// kernels times MPS load (.mps.gz parse and .mipc map), the feasibility
+// check (1 thread and default; and the mip_core CPU back end on double and
+// float storage, whose counts are checked against it), incremental
+// activity updates, candidate pair generation and one 2-opt sweep. Without inst= it picks a small, a
+// medium and a large instance by file size.
+//
+// Results are appended to <out>/heuristics.csv, incumbents.csv and
+// kernels.csv, tagged with run time, git revision and host. Each new row is
+// compared with the last one of the same host / instance / heuristic and
+// time limit, or kernel, and slowdowns (kernels > 10%, primal integral
+// > 10%) are printed as REGRESSION.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "feas_check.hpp"
+#include "ls_state.hpp"
+#include "mip_cache.hpp"
+#include "mip_core.hpp"
+#include "mip_sol.h"
+#include "mps_reader.hpp"
+#include "pair_gen.hpp"
+#include "sol_reader.hpp"
+#include "two_opt_cpu.hpp"
+
+namespace fs = std::filesystem;
+using namespace std;
+
+// name, command ({mps} {name} {id} {time} {run}), incumbent directory.
+// {run} = bench_<heuristic>_<instance> is the instance name the heuristic
+// runs under, so its incumbents never mix with (or clear) real results.
+struct Heuristic { const char* name; const char* cmd; const char* sols; };
+
+static const Heuristic HEURISTICS[]={
+    {"fp2opt",      "./fp2opt {mps} {run} {time}",                  "solFiles/fp2Opt/{run}"},
+    {"fp2opt_b1",   "./fp2opt {mps} {run} {time} batch=1",          "solFiles/fp2Opt/{run}"},
+    {"fp2opt_p4",   "./fp2opt {mps} {run} {time} pumps=4",          "solFiles/fp2Opt/{run}"},
+    {"fp2opt_plain","./fp2opt {mps} {run} {time} round=plain",      "solFiles/fp2Opt/{run}"},
+    {"fp2opt_fj0",  "./fp2opt {mps} {run} {time} fj=0",             "solFiles/fp2Opt/{run}"},
+    {"fp2opt_lns0", "./fp2opt {mps} {run} {time} lns=0",            "solFiles/fp2Opt/{run}"},
+    {"fp2opt_pdlp", "./fp2opt {mps} {run} {time} relax=results_pdlp_1e-06/relaxed_{id}_sol.txt",
+                                                                    "solFiles/fp2Opt/{run}"},
+};
+
+struct Reference { double best_obj=NAN, bound=NAN; };
+
+// ---- helpers ----------------------------------------------------------------
+
+static double now(){
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static string subst(string s, const map<string,string>& v){
+    for(auto& [k,val]:v){
+        string key="{"+k+"}";
+        for(size_t p;(p=s.find(key))!=string::npos;) s.replace(p,key.size(),val);
+    }
+    return s;
+}
+
+static vector<string> split(const string& s, char sep){
+    vector<string> out;
+    string cur;
+    istringstream in(s);
+    while(getline(in,cur,sep)) if(!cur.empty()) out.push_back(cur);
+    return out;
+}
+
+static string shell_line(const string& cmd){
+    string out;
+    FILE* p=popen(cmd.c_str(),"r");
+    if(!p) return out;
+    char buf[256];
+    if(fgets(buf,sizeof(buf),p)) out=buf;
+    pclose(p);
+    while(!out.empty() && (out.back()=='\n' || out.back()=='\r')) out.pop_back();
+    return out;
+}
+
+static string run_tag(){
+    char t[32];
+    time_t tt=time(nullptr);
+    strftime(t,sizeof(t),"%Y-%m-%dT%H:%M:%S",localtime(&tt));
+    return t;
+}
+
+// obj.csv (comma) and instance_5m_bounds.txt (tab): instance_name,best_obj_value,best_bound
+static void load_reference(const string& file, map<string,Reference>& ref, bool bound_only){
+    ifstream in(file);
+    string ln;
+    getline(in,ln);
+    while(getline(in,ln)){
+        replace(ln.begin(),ln.end(),'\t',',');
+        vector<string> f=split(ln,',');
+        if(f.size()<3) continue;
+        Reference& r=ref[f[0]];
+        if(!bound_only) r.best_obj=atof(f[1].c_str());
+        r.bound=atof(f[2].c_str());
+    }
+}
+
+// primal gap of Berthold: 0 at the best known value, 1 with no solution or
+// opposite signs
+static double primal_gap(double obj, double best){
+    if(std::isnan(obj)) return 1;
+    if(std::isnan(best)) return NAN;
+    if(fabs(obj-best)<1e-9) return 0;
+    if(obj*best<0) return 1;
+    return min(1.0,fabs(obj-best)/max(fabs(obj),fabs(best)));
+}
+
+// in the model's own sense, like the reference values
+static double obj_value(const MipView& P, const vector<double>& x){
+    double o=P.obj_offset;
+    for(int j=0;j<P.n;j++) o+=P.obj[j]*x[j];
+    return P.obj_sense*o;
+}
+
+// rows (check_violation), bounds and integrality
+static bool check_point(const MipView& P, const vector<double>& x, double tol){
+    for(int j=0;j<P.n;j++){
+        if(x[j]<P.lb[j]-tol || x[j]>P.ub[j]+tol) return false;
+        if(P.is_int[j] && fabs(x[j]-nearbyint(x[j]))>tol) return false;
+    }
+    ViolationReport R;
+    check_violation(P,x.data(),R,tol,false);
+    return R.feasible();
+}
+
+// appends rows to a CSV file, writing the header when it is new
+struct History {
+    string path;
+    FILE* f=nullptr;
+    History(const string& p, const char* header) : path(p) {
+        bool fresh=!fs::exists(p);
+        f=fopen(p.c_str(),"a");
+        if(f && fresh) fprintf(f,"%s\n",header);
+    }
+    ~History(){ if(f) fclose(f); }
+};
+
+// last value of column `val` per key (columns `keys`) in an existing history
+static map<string,double> last_values(const string& path, const vector<int>& keys, int val){
+    map<string,double> last;
+    ifstream in(path);
+    string ln;
+    getline(in,ln);
+    while(getline(in,ln)){
+        vector<string> f;
+        string cur; istringstream s(ln);
+        while(getline(s,cur,',')) f.push_back(cur);
+        if((int)f.size()<=val || f[val].empty()) continue;
+        string k;
+        for(int c:keys) if(c<(int)f.size()) k+=f[c]+"|";
+        last[k]=atof(f[val].c_str());
+    }
+    return last;
+}
+
+static vector<string> all_instances(){
+    vector<string> v;
+    error_code ec;
+    for(auto& e:fs::directory_iterator("test_set/instances",ec)){
+        string p=e.path().string();
+        if(p.size()>7 && p.compare(p.size()-7,7,".mps.gz")==0) v.push_back(p);
+    }
+    sort(v.begin(),v.end());
+    return v;
+}
+
+static string inst_path(const string& id){
+    return "test_set/instances/instance_"+id+".mps.gz";
+}
+
+static string inst_name(const string& path){
+    string n=fs::path(path).filename().string();
+    return n.substr(0,n.find('.'));
+}
+
+// ---- heuristics ---------------------------------------------------------------
+
+struct Incumbent { double t, obj; bool feasible; string source; };
+
+// launches cmd with output to log; kills it (process group) after wall seconds
+static int run_cmd(const string& cmd, const string& log, double wall){
+    fflush(stdout);
+    pid_t pid=fork();
+    if(pid==0){
+        setpgid(0,0);
+        FILE* f=freopen(log.c_str(),"w",stdout);
+        if(f) dup2(fileno(stdout),2);
+        execl("/bin/sh","sh","-c",cmd.c_str(),(char*)nullptr);
+        _exit(127);
+    }
+    if(pid<0) return -1;
+    setpgid(pid,pid);
+    double t0=now();
+    int status=0;
+    bool killed=false;
+    while(waitpid(pid,&status,WNOHANG)==0){
+        if(!killed && now()-t0>wall){ kill(-pid,SIGKILL); killed=true; }
+        usleep(20000);
+    }
+    if(killed) return -2;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+// incumbent_*.msol in dir, in time order
+static vector<Incumbent> read_incumbents(const string& dir, const MipView& P, double start){
+    vector<Incumbent> inc;
+    error_code ec;
+    for(auto& e:fs::directory_iterator(dir,ec)){
+        string p=e.path().string();
+        if(!msol_has_suffix(p.c_str())) continue;
+        MipSolHeader h;
+        FILE* f=fopen(p.c_str(),"rb");
+        if(!f) continue;
+        bool ok=fread(&h,sizeof(h),1,f)==1;
+        fclose(f);
+        LoadedSol S;
+        if(!ok || !load_solution(p,P,S)) continue;
+        Incumbent c;
+        c.t=h.timestamp-start;
+        c.obj=obj_value(P,S.x);
+        c.feasible=check_point(P,S.x,1e-6);
+        c.source=string(h.source,strnlen(h.source,sizeof(h.source)));
+        inc.push_back(c);
+    }
+    sort(inc.begin(),inc.end(),[](const Incumbent& a,const Incumbent& b){ return a.t<b.t; });
+    return inc;
+}
+
+static int bench_heuristics(const vector<string>& insts, const vector<string>& heurs, int limit,
+                            const string& out, const map<string,Reference>& ref,
+                            const string& tag, const string& rev, const string& host){
+    string hpath=out+"/heuristics.csv";
+    map<string,double> prev=last_values(hpath,{2,3,4,5},7);
+    History H(hpath,"run,git,host,heuristic,instance,time_limit,status,primal_integral,"
+                    "ttff,final_obj,best_obj,final_gap,bound_gap,incumbents,infeasible");
+    History I(out+"/incumbents.csv","run,git,host,heuristic,instance,t,obj,feasible,source");
+    if(!H.f || !I.f){ cerr << "Cannot write to " << out << "\n"; return 1; }
+    fs::create_directories(out+"/logs");
+
+    int regressions=0;
+    for(const Heuristic& hs:HEURISTICS){
+        if(!heurs.empty() && find(heurs.begin(),heurs.end(),hs.name)==heurs.end()) continue;
+        for(const string& path:insts){
+            string name=inst_name(path);
+            string id=name.substr(name.find('_')+1);
+            map<string,string> vars={{"mps",path},{"name",name},{"id",id},{"time",to_string(limit)},
+                                     {"run","bench_"+string(hs.name)+"_"+name}};
+            string dir=subst(hs.sols,vars);
+
+            // only this run's incumbents are scored; dir is bench-only
+            error_code ec;
+            for(auto& e:fs::directory_iterator(dir,ec))
+                if(e.path().filename().string().rfind("incumbent_",0)==0) fs::remove(e.path(),ec);
+
+            MipInstance M; string err;
+            if(!M.open(path,&err)){ cerr << name << ": " << err << "\n"; continue; }
+            const MipView& P=M.view;
+
+            string log=out+"/logs/"+string(hs.name)+"_"+name+".log";
+            double start=msol_now();
+            int rc=run_cmd(subst(hs.cmd,vars),log,limit+60.0);
+            vector<Incumbent> inc=read_incumbents(dir,P,start);
+
+            Reference R;
+            auto it=ref.find(name);
+            if(it!=ref.end()) R=it->second;
+
+            // primal integral: gap 1 until the first feasible point, then
+            // the gap of the best point found so far
+            double pi=0, t_prev=0, gap=1, best=NAN, ttff=NAN;
+            int infeasible=0;
+            for(const Incumbent& c:inc){
+                if(!c.feasible){ infeasible++; continue; }
+                double t=min(max(c.t,0.0),(double)limit);
+                if(std::isnan(ttff)) ttff=t;
+                pi+=gap*(t-t_prev);
+                t_prev=t;
+                if(std::isnan(best) || c.obj*P.obj_sense<best*P.obj_sense) best=c.obj;
+                gap=primal_gap(best,R.best_obj);
+            }
+            pi+=gap*(limit-t_prev);
+            if(std::isnan(R.best_obj)) pi=NAN;
+            double fgap=std::isnan(best)?NAN:primal_gap(best,R.best_obj);
+            double bgap=(std::isnan(best) || std::isnan(R.bound)) ? NAN
+                       : fabs(best-R.bound)/max(1e-9,max(fabs(best),fabs(R.bound)));
+
+            const char* status= rc==-2 ? "killed" : rc!=0 ? "fail" : std::isnan(best) ? "nosol" : "ok";
+            fprintf(H.f,"%s,%s,%s,%s,%s,%d,%s,%.6g,%.6g,%.10g,%.10g,%.6g,%.6g,%zu,%d\n",
+                    tag.c_str(),rev.c_str(),host.c_str(),hs.name,name.c_str(),limit,status,
+                    pi,ttff,best,R.best_obj,fgap,bgap,inc.size(),infeasible);
+            for(const Incumbent& c:inc)
+                fprintf(I.f,"%s,%s,%s,%s,%s,%.6f,%.10g,%d,%s\n",tag.c_str(),rev.c_str(),host.c_str(),
+                        hs.name,name.c_str(),c.t,c.obj,(int)c.feasible,c.source.c_str());
+            fflush(H.f); fflush(I.f);
+
+            printf("%-12s %-12s %-6s ttff %8.2f  integral %8.3f  gap %9.3g  (%zu incumbents)\n",
+                   hs.name,name.c_str(),status,ttff,pi,fgap,inc.size());
+            auto p=prev.find(host+"|"+hs.name+"|"+name+"|"+to_string(limit)+"|");
+            if(p!=prev.end() && !std::isnan(pi) && pi>p->second*1.1+1e-3){
+                printf("  REGRESSION: primal integral %.3f, was %.3f\n",pi,p->second);
+                regressions++;
+            }
+        }
+    }
+    return regressions ? 2 : 0;
+}
+
+// ---- kernels --------------------------------------------------------------------
+
+struct Timing { double best=0, median=0; };
+
+template<class F>
+static Timing time_it(int reps, F&& f){
+    vector<double> t;
+    for(int r=0;r<reps;r++){
+        double a=now();
+        f();
+        t.push_back((now()-a)*1e3);
+    }
+    sort(t.begin(),t.end());
+    return {t.front(),t[t.size()/2]};
+}
+
+static int bench_kernels(const vector<string>& insts, int reps, int threads, const string& out,
+                         const string& tag, const string& rev, const string& host){
+    string kpath=out+"/kernels.csv";
+    map<string,double> prev=last_values(kpath,{2,3,7,8},11);
+    History K(kpath,"run,git,host,instance,rows,cols,nnz,kernel,threads,reps,best_ms,median_ms");
+    if(!K.f){ cerr << "Cannot write to " << out << "\n"; return 1; }
+
+    int regressions=0;
+    for(const string& path:insts){
+        string name=inst_name(path);
+        MipProblem parsed; string err;
+        Timing t_parse=time_it(1,[&]{ read_mps(path,parsed,&err); });
+        if(!err.empty() || parsed.n==0){ cerr << name << ": " << err << "\n"; continue; }
+        string cpath=mip_cache_path(path);
+        if(!fs::exists(cpath)) write_mip_cache(cpath,parsed);
+        Timing t_map=time_it(reps,[&]{ MipInstance M; M.open(cpath); });
+
+        MipView P=parsed.view();
+        vector<double> x(P.n);
+        for(int j=0;j<P.n;j++) x[j]=P.lb[j]>-MIP_INF ? P.lb[j] : (P.ub[j]<MIP_INF ? min(P.ub[j],0.0) : 0.0);
+        for(double& v:x) v=(float)v;       // the same point in the float check
+
+        ViolationReport R;
+        Timing t_feas1=time_it(reps,[&]{ check_violation(P,x.data(),R,1e-8,false,1); });
+        int ft=threads>0?threads:feas_default_threads(P);
+        Timing t_feas;
+        if(ft>1) t_feas=time_it(reps,[&]{ check_violation(P,x.data(),R,1e-8,false,ft); });
+        size_t nviol=R.violated.size();
+
+        // the same check on the mip_core CPU back end, double and float
+        // storage (float: certain + uncertain rows bracket feas_check's)
+        using mip_core::Backend;
+        mip_core::CoreModel<double,int> M64=mip_core::core_model(P);
+        mip_core::CoreStorage<float> S32(P);
+        mip_core::CoreModel<float,int> M32=S32.model();
+        vector<float> x32(x.begin(),x.end());
+        vector<double> act(P.m), mag(P.m);
+        mip_core::FeasResult<double> F64, F32;
+        Timing t_core64=time_it(reps,[&]{
+            mip_core::activities<Backend::CPU>(M64,x.data(),act.data(),(double*)nullptr,1);
+            F64=mip_core::check_feasibility<Backend::CPU>(M64,act.data(),1e-8,(const double*)nullptr,1);
+        });
+        Timing t_core32=time_it(reps,[&]{
+            mip_core::activities<Backend::CPU>(M32,x32.data(),act.data(),mag.data(),1);
+            F32=mip_core::check_feasibility<Backend::CPU>(M32,act.data(),1e-8,mag.data(),1);
+        });
+        if((size_t)F64.violated!=nviol || (size_t)F32.violated>nviol || (size_t)(F32.violated+F32.uncertain)<nviol)
+            printf("%s: core check MISMATCH: feas_check %zu, double %lld, float %lld + %lld uncertain\n",
+                   name.c_str(),nviol,F64.violated,F32.violated,F32.uncertain);
+
+        // 100k single-column +-1 moves, then undone in reverse; bounds are not
+        // checked, only the activity update cost is timed
+        LsState ls; ls.init(P,x.data());
+        mt19937 rng(1);
+        vector<pair<int,double>> moves(100000);
+        for(auto& m:moves){
+            m.first=(int)(rng()%P.n);
+            m.second=(rng()&1) ? 1.0 : -1.0;
+        }
+        Timing t_move=time_it(reps,[&]{
+            for(auto& m:moves) ls.move(m.first,m.second);
+            for(auto it=moves.rbegin();it!=moves.rend();++it) ls.move(it->first,-it->second);
+            ls.clear_dirty();
+        });
+
+        CandidatePairs C;
+        Timing t_pairs=time_it(1,[&]{ build_candidate_pairs(P,C); });
+        ls.refresh();
+        TwoOptEngine E(P,C,threads);
+        Timing t_sweep=time_it(reps,[&]{ E.best_move(ls.x.data(),ls.act.data()); });
+
+        struct Row { const char* k; int th; int reps; Timing t; };
+        vector<Row> rows={
+            {"mps_parse",1,1,t_parse},{"mipc_map",1,reps,t_map},{"feas_check",1,reps,t_feas1},
+        };
+        if(ft>1) rows.push_back({"feas_check",ft,reps,t_feas});
+        rows.push_back({"core_check_f64",1,reps,t_core64});
+        rows.push_back({"core_check_f32",1,reps,t_core32});
+        rows.push_back({"ls_move_200k",1,reps,t_move});
+        rows.push_back({"pair_gen",1,1,t_pairs});
+        rows.push_back({"two_opt_sweep",E.threads(),reps,t_sweep});
+        printf("%s  %d x %d, %d nnz, %lld pairs\n",name.c_str(),P.m,P.n,P.nnz,(long long)C.num_pairs());
+        for(auto& r:rows){
+            fprintf(K.f,"%s,%s,%s,%s,%d,%d,%d,%s,%d,%d,%.4f,%.4f\n",tag.c_str(),rev.c_str(),host.c_str(),
+                    name.c_str(),P.m,P.n,P.nnz,r.k,r.th,r.reps,r.t.best,r.t.median);
+            printf("  %-14s %3d thr  best %10.3f ms  median %10.3f ms",r.k,r.th,r.t.best,r.t.median);
+            auto p=prev.find(host+"|"+name+"|"+r.k+"|"+to_string(r.th)+"|");
+            if(p!=prev.end() && r.reps>1 && r.t.median>p->second*1.1+0.05){
+                printf("  REGRESSION (was %.3f)",p->second);
+                regressions++;
+            }
+            printf("\n");
+        }
+        fflush(K.f);
+    }
+    return regressions ? 2 : 0;
+}
+
+int main(int argc, char** argv){
+    if(argc<2 || (strcmp(argv[1],"heur")!=0 && strcmp(argv[1],"kernels")!=0)){
+        printf("usage: ./bench heur    [inst=01,03,...] [heur=fp2opt,...] [time=60] [out=bench_results]\n"
+               "       ./bench kernels [inst=01,03,...] [reps=5] [threads=N] [out=bench_results]\n");
+        return 1;
+    }
+    string mode=argv[1], out="bench_results";
+    vector<string> ids, heurs;
+    int limit=60, reps=5, threads=0;
+    for(int a=2;a<argc;a++){
+        string s=argv[a];
+        size_t eq=s.find('=');
+        string k=s.substr(0,eq), v=eq==string::npos?"":s.substr(eq+1);
+        if(k=="inst") ids=split(v,',');
+        else if(k=="heur") heurs=split(v,',');
+        else if(k=="time") limit=max(1,atoi(v.c_str()));
+        else if(k=="reps") reps=max(1,atoi(v.c_str()));
+        else if(k=="threads") threads=atoi(v.c_str());
+        else if(k=="out") out=v;
+        else { cerr << "unknown option " << s << "\n"; return 1; }
+    }
+
+    vector<string> insts;
+    for(auto& id:ids) insts.push_back(inst_path(id));
+    if(insts.empty()){
+        insts=all_instances();
+        if(mode=="kernels" && insts.size()>3){
+            // small, medium and large by compressed size
+            sort(insts.begin(),insts.end(),[](const string& a,const string& b){
+                return fs::file_size(a)<fs::file_size(b);
+            });
+            size_t n=insts.size();
+            insts={insts[n/10],insts[n/2],insts[n-1-n/10]};
+        }
+    }
+    if(insts.empty()){ cerr << "No instances\n"; return 1; }
+
+    fs::create_directories(out);
+    string tag=run_tag();
+    string rev=shell_line("git rev-parse --short HEAD 2>/dev/null");
+    char host[256]={0};
+    gethostname(host,sizeof(host)-1);
+    if(rev.empty()) rev="-";
+
+    if(mode=="kernels") return bench_kernels(insts,reps,threads,out,tag,rev,host);
+
+    map<string,Reference> ref;
+    load_reference("obj.csv",ref,false);
+    load_reference("instance_5m_bounds.txt",ref,true);
+    return bench_heuristics(insts,heurs,limit,out,ref,tag,rev,host);
+}
@@ -48,12 +48,15 @@ pip install --pre --extra-index-url=https://pypi.nvidia.com --extra-index-url=ht
   'libcuopt-cu13==25.12.*'
 
 
-g++ unzip.cpp -o unzip_all -lz
+g++ -std=c++17 -O2 unzip.cpp -o unzip_all -lz
 ./unzip_all
 
-g++ relax.cpp -o relax -lCbc -lClp -lOsiClp -lOsi -lm
+g++ -std=c++17 -I/usr/include/coin relax.cpp -o relax -lCbc -lClp -lOsiClp -lOsi -lCoinUtils -lz -lm
 ./relax
 
+g++ -std=c++17 -O2 batch_run.cpp -o batch_run -lz -lpthread
+g++ -std=c++17 -O2 -march=native -fopenmp-simd bench.cpp -o bench -lz -lpthread
+
 # 7) Apply new environment to this session
 source ~/.bashrc
 
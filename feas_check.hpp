@@ -0,0 +1,138 @@
+// feas_check.hpp  (header-only, link with -lpthread;
+//                  -O3 -fopenmp-simd vectorizes the slack loop)
+//
+// CPU feasibility / violation engine for rlo <= Ax <= rhi, covering
+// <=, >=, = and ranged rows. One pass returns the total and maximum
+// violation, the violated rows (ascending) and the signed slack
+//     slack[r] = min(rhi[r]-a_r, a_r-rlo[r])      (< 0 when violated).
+// Rows are split into nnz-balanced chunks, one per thread; each thread
+// reduces into its own partial result and the partials are merged at
+// the end, so there is no shared state and no host-side rescan.
+// Activities come from spmv.hpp: the CSR kernel of the widest ISA, or a
+// prebuilt spmv::Matrix (SELL where it pays) for repeated checks.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "mip_problem.hpp"
+#include "spmv.hpp"
+
+struct ViolationReport {
+    double total=0, max=0;
+    std::vector<int> violated;
+    std::vector<double> slack;          // filled when want_slack
+
+    bool feasible() const { return violated.empty(); }
+};
+
+namespace feas_detail {
+
+struct Partial {
+    double total=0, max=0;
+    std::vector<int> violated;
+};
+
+// act[r-r0] holds the activity of row r
+inline void rows(const MipView& P, const double* act, double tol, int r0, int r1,
+                 double* slack, Partial& out){
+    double total=0, mx=0;
+#pragma omp simd reduction(+:total) reduction(max:mx)
+    for(int r=r0;r<r1;r++){
+        double a=act[r-r0];
+        double hi=P.rhi[r]-a, lo=a-P.rlo[r];
+        double sl=hi<lo?hi:lo;
+        double v=sl<0?-sl:0;
+        if(slack) slack[r]=sl;
+        total+=v;
+        mx=v>mx?v:mx;
+    }
+    for(int r=r0;r<r1;r++){
+        double a=act[r-r0];
+        if(a>P.rhi[r]+tol || a<P.rlo[r]-tol) out.violated.push_back(r);
+    }
+    out.total=total;
+    out.max=mx;
+}
+
+// Row boundaries giving each of k chunks about nnz/k nonzeros.
+inline std::vector<int> split_rows(const MipView& P, int k){
+    std::vector<int> b(k+1,P.m);
+    b[0]=0;
+    long long nz=P.nnz;
+    for(int t=1;t<k;t++){
+        long long target=nz*t/k;
+        b[t]=(int)(std::lower_bound(P.rp,P.rp+P.m+1,(int)target)-P.rp);
+        if(b[t]<b[t-1]) b[t]=b[t-1];
+        if(b[t]>P.m) b[t]=P.m;
+    }
+    return b;
+}
+
+template<class Act>
+void run(const MipView& P, ViolationReport& R, bool want_slack, int threads, Act&& act){
+    if(want_slack) R.slack.resize(P.m);
+    else R.slack.clear();
+    double* slack=want_slack?R.slack.data():nullptr;
+
+    std::vector<int> b=split_rows(P,threads);
+    std::vector<Partial> part(threads);
+    auto work=[&](int t){ act(b[t],b[t+1],slack,part[t]); };
+    if(threads==1) work(0);
+    else {
+        std::vector<std::thread> th;
+        for(int t=1;t<threads;t++) th.emplace_back(work,t);
+        work(0);
+        for(auto& t:th) t.join();
+    }
+
+    R.total=0; R.max=0; R.violated.clear();
+    for(auto& p:part){
+        R.total+=p.total;
+        R.max=std::max(R.max,p.max);
+        R.violated.insert(R.violated.end(),p.violated.begin(),p.violated.end());
+    }
+}
+
+} // namespace feas_detail
+
+inline int feas_default_threads(const MipView& P){
+    int hw=(int)std::thread::hardware_concurrency();
+    if(hw<1) hw=1;
+    // below ~64k nonzeros spawning threads costs more than it saves
+    int by_size=(int)(P.nnz/65536)+1;
+    return std::min(hw,by_size);
+}
+
+// Checks x against all rows. threads<=0 picks a default from the size.
+inline void check_violation(const MipView& P, const double* x, ViolationReport& R,
+                            double tol=1e-8, bool want_slack=true, int threads=0){
+    if(threads<=0) threads=feas_default_threads(P);
+    feas_detail::run(P,R,want_slack,threads,[&](int r0, int r1, double* slack, feas_detail::Partial& out){
+        std::vector<double> act(r1-r0);
+        spmv::csr_rows(P,x,r0,r1,act.data());
+        feas_detail::rows(P,act.data(),tol,r0,r1,slack,out);
+    });
+}
+
+// Same, with the activities from A (built on the model to check); for
+// callers that check many points against one model.
+inline void check_violation(const spmv::Matrix& A, const double* x, ViolationReport& R,
+                            double tol=1e-8, bool want_slack=true, int threads=0){
+    const MipView& P=A.view();
+    if(threads<=0) threads=feas_default_threads(P);
+    std::vector<double> act(P.m);
+    A.multiply(x,act.data(),threads);
+    feas_detail::run(P,R,want_slack,threads,[&](int r0, int r1, double* slack, feas_detail::Partial& out){
+        feas_detail::rows(P,act.data()+r0,tol,r0,r1,slack,out);
+    });
+}
+
+inline bool is_feasible(const MipView& P, const double* x, double tol=1e-8){
+    ViolationReport R;
+    check_violation(P,x,R,tol,false);
+    return R.feasible();
+}
@@ -0,0 +1,400 @@
+// feas_jump.hpp  (header-only, link with -lpthread)
+//
+// Feasibility-jump style weighted 1-opt. A walker minimises
+//
+//   F(x) = sum_r w_r viol_r(x) + w_0 sum_j c_j x_j / max|c|
+//
+// by moving one column at a time to its jump value: the minimiser of F
+// over x_j in [l_j, u_j] with every other column fixed. In x_j, F is convex
+// piecewise linear (each row of j adds up to two breakpoints), so the jump
+// is found in one pass over the sorted breakpoints; integer columns take
+// the better of the two neighbouring integers. Moves are of any length
+// within the bounds, not just +-1.
+//
+// The score (decrease of F) of every column sits in an indexed max-heap.
+// A move of j changes the activities of the rows of j only, so only the
+// columns of those rows are re-scored from the CSC; rows longer than
+// long_row are skipped and the heap top is then re-scored before it is
+// applied, with a full rescan before the next weight update. With no
+// improving jump left the weights of the violated rows grow by one, or, at
+// a feasible point, w_0 does, which turns the walk into an objective
+// descent. Every move lowers F, so a walker cannot cycle between updates.
+//
+// Walkers own their point, weights and heap and differ in start point and
+// seed; they share only the incumbent (incumbent.hpp). A feasible point is
+// offered to it when the walker is about to leave it or gets stuck there,
+// after a full check (feas_check.hpp).
+//
+//   FjConfig cfg; cfg.seed=s;
+//   std::vector<FjStats> st=run_feas_jump(P, x0, walkers, cfg, inc, deadline);
+//   st=run_feas_jump(P, starts, cfg, inc, deadline);    // own start points
+//
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "feas_check.hpp"
+#include "incumbent.hpp"
+#include "mip_core.hpp"
+#include "mip_problem.hpp"
+#include "prof.hpp"
+#include "spmv.hpp"
+
+struct FjConfig {
+    uint64_t seed=1;
+    double obj_weight=0;            // initial w_0; 0 = feasibility first
+    int long_row=1000;              // longer rows are not re-scored after every move
+    long long stall=200000;         // moves + updates without a better feasible point, once one is found
+    double tol=1e-8;                // row feasibility tolerance (as check_violation)
+};
+
+struct FjStats {
+    long long moves=0, bumps=0, rescans=0;
+    int feasible=0;                 // improving feasible points reached by the walker
+    bool found=false;               // published an improving point
+    double first_feasible=-1;       // seconds to the first feasible point
+};
+
+class FeasJump {
+public:
+    FjConfig cfg;
+    FjStats st;
+
+    void init(const MipView& p, const FjConfig& c){
+        P=&p; cfg=c;
+        lb.resize(p.n); ub.resize(p.n); chat.assign(p.n,0);
+        double cmax=0;
+        for(int j=0;j<p.n;j++){
+            lb[j]=p.lb[j]; ub[j]=p.ub[j];
+            if(p.is_int[j]){
+                if(fin(lb[j])) lb[j]=std::ceil(lb[j]-1e-9);
+                if(fin(ub[j])) ub[j]=std::floor(ub[j]+1e-9);
+            }
+            cmax=std::max(cmax,std::fabs(p.obj[j]));
+        }
+        has_obj=cmax>0;
+        if(has_obj) for(int j=0;j<p.n;j++) chat[j]=p.obj[j]/cmax;
+        w.assign(p.m,1.0);
+        w0=c.obj_weight;
+        act.assign(p.m,0);
+        vpos.assign(p.m,-1);
+        jump.assign(p.n,0); score.assign(p.n,0);
+        hpos.assign(p.n,-1);
+        mark.assign(p.n,0);
+    }
+
+    // x0 rounded and clamped into the (integer) bounds
+    void start(const std::vector<double>& x0){
+        const MipView& p=*P;
+        x.resize(p.n);
+        for(int j=0;j<p.n;j++){
+            double v= p.is_int[j] ? std::round(x0[j]) : x0[j];
+            x[j]=std::min(std::max(v,lb[j]),ub[j]);
+        }
+        refresh();
+    }
+
+    FjStats run(SharedIncumbent& inc, std::chrono::steady_clock::time_point deadline){
+        PROF_SCOPE("fj.walker");
+        auto t0=std::chrono::steady_clock::now();
+        best=MIP_INF; pending=false;
+        long long last_better=0;
+        for(long long it=0;;it++){
+            if((it&255)==0 && std::chrono::steady_clock::now()>=deadline) break;
+            if(vlist.empty()){
+                double o=objective();
+                if(o<best-1e-9*(1+std::fabs(best))){
+                    best=o; pending=true; last_better=st.moves+st.bumps;
+                    st.feasible++;
+                    if(st.first_feasible<0)
+                        st.first_feasible=std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+                }
+                if(!has_obj){ publish(inc); break; }
+            }
+            if(st.feasible && st.moves+st.bumps-last_better>cfg.stall) break;
+
+            int j=top();
+            if(j<0){
+                if(stale){ st.rescans++; rescore_all(); stale=false; continue; }
+                if(vlist.empty()){
+                    publish(inc);
+                    w0+=1;
+                    rescore_all();
+                } else {
+                    bump();
+                }
+                st.bumps++;
+                continue;
+            }
+            if(pending && vlist.empty() && leaves_feasible(j,jump[j])) publish(inc);
+            move(j,jump[j]);
+            st.moves++;
+        }
+        if(vlist.empty()) publish(inc);
+        PROF_COUNT("fj.moves",st.moves);
+        PROF_COUNT("fj.bumps",st.bumps);
+        return st;
+    }
+
+    const std::vector<double>& point() const { return x; }
+
+private:
+    const MipView* P=nullptr;
+    std::vector<double> lb, ub, chat, w, x, act, jump, score;
+    double w0=0, best=MIP_INF;
+    bool has_obj=false, stale=false, pending=false;
+    std::vector<int> vlist, vpos;           // violated rows
+    std::vector<int> heap, hpos;            // columns with score > EPS
+    std::vector<unsigned> mark;
+    unsigned stamp=0;
+    std::vector<std::pair<double,double>> bp;
+
+    static constexpr double EPS=1e-9;
+
+    static bool fin(double v){ return std::fabs(v)<MIP_INF; }
+
+    double viol(int r, double a) const { return mip_core::row_violation(a,P->rlo[r],P->rhi[r]); }
+
+    double objective() const {
+        double o=0;
+        for(int j=0;j<P->n;j++) o+=P->obj[j]*x[j];
+        return o;
+    }
+
+    void set_viol(int r){
+        bool v=viol(r,act[r])>cfg.tol;
+        if(v && vpos[r]<0){ vpos[r]=(int)vlist.size(); vlist.push_back(r); }
+        else if(!v && vpos[r]>=0){
+            int s=vlist.back();
+            vlist[vpos[r]]=s; vpos[s]=vpos[r];
+            vlist.pop_back(); vpos[r]=-1;
+        }
+    }
+
+    // activities from scratch (drops rounding drift), all scores
+    void refresh(){
+        const MipView& p=*P;
+        spmv::csr_rows(p,x.data(),0,p.m,act.data());
+        for(int r=0;r<p.m;r++) set_viol(r);
+        rescore_all();
+    }
+
+    // F restricted to the terms of column j, at x_j = v
+    double local_f(int j, double v) const {
+        const MipView& p=*P;
+        double d=v-x[j], f=w0*chat[j]*v;
+        for(int q=p.cp[j];q<p.cp[j+1];q++){
+            int r=p.ri[q];
+            f+=w[r]*viol(r,act[r]+p.cv[q]*d);
+        }
+        return f;
+    }
+
+    void rescore(int j){
+        const MipView& p=*P;
+        double L=lb[j], U=ub[j], xj=x[j];
+        if(L==U){ set_score(j,xj,0); return; }
+        // right derivative of F at L, and the slope increase at each breakpoint
+        bp.clear();
+        double s=w0*chat[j], mag=std::fabs(s);
+        for(int q=p.cp[j];q<p.cp[j+1];q++){
+            int r=p.ri[q]; double a=p.cv[q];
+            if(a==0) continue;
+            double k=w[r]*std::fabs(a), res=act[r]-a*xj;
+            // row r is satisfied for x_j in [lo, hi]
+            double lo, hi;
+            if(a>0){
+                lo=p.rlo[r]>-MIP_INF ? (p.rlo[r]-res)/a : -HUGE_VAL;
+                hi=p.rhi[r]< MIP_INF ? (p.rhi[r]-res)/a :  HUGE_VAL;
+            } else {
+                lo=p.rhi[r]< MIP_INF ? (p.rhi[r]-res)/a : -HUGE_VAL;
+                hi=p.rlo[r]>-MIP_INF ? (p.rlo[r]-res)/a :  HUGE_VAL;
+            }
+            mag+=k;
+            if(lo>L){ s-=k; if(lo<U) bp.push_back({lo,k}); }
+            if(hi<U){ if(hi<=L) s+=k; else bp.push_back({hi,k}); }
+        }
+        std::sort(bp.begin(),bp.end());
+        double eps=1e-12*(1+mag);
+        double lo=L, hi;
+        size_t i=0;
+        while(s<-eps && i<bp.size()){ lo=bp[i].first; s+=bp[i].second; i++; }
+        if(s<-eps) lo=hi=U;                                 // descends to U
+        else if(s<=eps) hi= i<bp.size() ? bp[i].first : U;   // flat on [lo, hi]
+        else hi=lo;
+        double t=std::min(std::max(xj,lo),hi);              // minimiser nearest x_j
+        if(!fin(t)){
+            // unbounded objective direction: stop at the last breakpoint
+            if(t>0) t= bp.empty() ? xj : std::max(xj,bp.back().first);
+            else    t= bp.empty() ? xj : std::min(xj,bp.front().first);
+        }
+        double f0=local_f(j,xj);
+        if(p.is_int[j]){
+            double a=std::min(std::max(std::floor(t),L),U), b=std::min(std::max(std::ceil(t),L),U);
+            double fa=local_f(j,a), fb= b!=a ? local_f(j,b) : fa;
+            if(fb<fa || (fb==fa && std::fabs(b-xj)<std::fabs(a-xj))){ a=b; fa=fb; }
+            set_score(j,a,a==xj ? 0 : f0-fa);
+        } else {
+            set_score(j,t,std::fabs(t-xj)<=1e-9*(1+std::fabs(xj)) ? 0 : f0-local_f(j,t));
+        }
+    }
+
+    void rescore_all(){
+        for(int j=0;j<P->n;j++) rescore(j);
+    }
+
+    // columns of row r, each once per stamp
+    template<class F> void for_row_cols(int r, F f){
+        const MipView& p=*P;
+        for(int q=p.rp[r];q<p.rp[r+1];q++){
+            int k=p.ci[q];
+            if(mark[k]!=stamp){ mark[k]=stamp; f(k); }
+        }
+    }
+
+    void next_stamp(){
+        if(++stamp==0){ std::fill(mark.begin(),mark.end(),0); stamp=1; }
+    }
+
+    void move(int j, double v){
+        const MipView& p=*P;
+        double d=v-x[j];
+        x[j]=v;
+        for(int q=p.cp[j];q<p.cp[j+1];q++){
+            int r=p.ri[q];
+            act[r]+=p.cv[q]*d;
+            set_viol(r);
+        }
+        next_stamp();
+        for(int q=p.cp[j];q<p.cp[j+1];q++){
+            int r=p.ri[q];
+            if(p.rp[r+1]-p.rp[r]>cfg.long_row){ stale=true; continue; }
+            for_row_cols(r,[&](int k){ rescore(k); });
+        }
+        if(mark[j]!=stamp) rescore(j);
+    }
+
+    void bump(){
+        next_stamp();
+        for(int r:vlist) w[r]+=1;
+        for(int r:vlist) for_row_cols(r,[&](int k){ rescore(k); });
+    }
+
+    bool leaves_feasible(int j, double v) const {
+        const MipView& p=*P;
+        double d=v-x[j];
+        for(int q=p.cp[j];q<p.cp[j+1];q++){
+            int r=p.ri[q];
+            if(viol(r,act[r]+p.cv[q]*d)>cfg.tol) return true;
+        }
+        return false;
+    }
+
+    void publish(SharedIncumbent& inc){
+        if(!pending) return;
+        pending=false;
+        double o=objective();
+        if(o>=inc.cutoff()) return;
+        if(!is_feasible(*P,x.data(),cfg.tol)){ refresh(); return; }   // drift
+        if(inc.offer(x,o,"fj")) st.found=true;
+    }
+
+    // best column after re-scoring the top while scores may be stale
+    int top(){
+        while(!heap.empty()){
+            int j=heap[0];
+            if(!stale) return j;
+            rescore(j);
+            if(!heap.empty() && heap[0]==j) return j;
+        }
+        return -1;
+    }
+
+    // ---- indexed max-heap on score ----
+    bool above(int a, int b) const { return score[a]>score[b] || (score[a]==score[b] && a<b); }
+
+    void set_score(int j, double v, double sc){
+        jump[j]=v; score[j]=sc;
+        if(sc>EPS){
+            if(hpos[j]<0){ hpos[j]=(int)heap.size(); heap.push_back(j); }
+            sift_up(hpos[j]); sift_down(hpos[j]);
+        } else if(hpos[j]>=0){
+            int i=hpos[j], l=heap.back();
+            heap[i]=l; hpos[l]=i;
+            heap.pop_back(); hpos[j]=-1;
+            if(i<(int)heap.size()){ sift_up(i); sift_down(hpos[l]); }
+        }
+    }
+
+    void place(int i, int j){ heap[i]=j; hpos[j]=i; }
+
+    void sift_up(int i){
+        int j=heap[i];
+        while(i>0){
+            int u=(i-1)/2;
+            if(!above(j,heap[u])) break;
+            place(i,heap[u]); i=u;
+        }
+        place(i,j);
+    }
+
+    void sift_down(int i){
+        int j=heap[i], n=(int)heap.size();
+        for(;;){
+            int c=2*i+1;
+            if(c>=n) break;
+            if(c+1<n && above(heap[c+1],heap[c])) c++;
+            if(!above(heap[c],j)) break;
+            place(i,heap[c]); i=c;
+        }
+        place(i,j);
+    }
+};
+
+// Start points of the default walkers: walker 0 from x0, walker 1 from 0,
+// the others from x0 with each column set to 0 with probability 1/2
+// (drawn with seed + k).
+inline std::vector<std::vector<double>> fj_starts(const MipView& P, const std::vector<double>& x0,
+                                                  int walkers, uint64_t seed){
+    std::vector<std::vector<double>> xs(std::max(1,walkers),x0);
+    for(int k=1;k<(int)xs.size();k++){
+        std::mt19937_64 rng(seed+k);
+        std::bernoulli_distribution coin(0.5);
+        for(int j=0;j<P.n;j++) if(k==1 || coin(rng)) xs[k][j]=0;
+    }
+    return xs;
+}
+
+// One walker per start point, walker k seeded with cfg.seed + k.
+inline std::vector<FjStats> run_feas_jump(const MipView& P, const std::vector<std::vector<double>>& starts,
+                                          const FjConfig& cfg, SharedIncumbent& inc,
+                                          std::chrono::steady_clock::time_point deadline){
+    int N=(int)starts.size();
+    std::vector<FjStats> st(N);
+    std::vector<std::thread> th;
+    auto walk=[&](int k){
+        FjConfig c=cfg; c.seed=cfg.seed+k;
+        FeasJump fj;
+        fj.init(P,c);
+        fj.start(starts[k]);
+        st[k]=fj.run(inc,deadline);
+    };
+    for(int k=1;k<N;k++) th.emplace_back(walk,k);
+    if(N>0) walk(0);
+    for(auto& t:th) t.join();
+    return st;
+}
+
+inline std::vector<FjStats> run_feas_jump(const MipView& P, const std::vector<double>& x0, int walkers,
+                                          const FjConfig& cfg, SharedIncumbent& inc,
+                                          std::chrono::steady_clock::time_point deadline){
+    return run_feas_jump(P,fj_starts(P,x0,walkers,cfg.seed),cfg,inc,deadline);
+}
@@ -0,0 +1,281 @@
+// fix_propagate.hpp  (header-only)
+//
+// Fix-and-propagate rounding of an LP point. Integer columns are fixed one
+// at a time, in a configurable order, to their rounding clamped into the
+// current domain; after every fix the bound changes are propagated through
+// the rows with min/max activities that are kept up to date incrementally
+// (a bound change of column j touches the rows of j only). A fix that
+// empties a domain or makes a row unsatisfiable is undone through the
+// trail and the other rounding is tried; when both fail the rounding is
+// kept and the rows it breaks are left out of further propagation. After
+// max_backtracks conflicts, or work_factor * nnz row entries visited, the
+// remaining columns are rounded into their current domains without
+// propagation. Continuous columns keep their LP value clamped to their
+// original bounds: the propagated domains only bound them under the
+// integer fixes and clamping into them moves them off rows they satisfy.
+//
+//   FixPropagate fp; fp.init(P);
+//   bool clean = fp.round(xlp, 0.5, xr);   // xr: full rounded point
+//
+// clean is about the integer part only: every fix was propagated without
+// a conflict left over. Rows with continuous columns can still be violated
+// by xr; for a pure integer model a clean point satisfies every row.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "mip_problem.hpp"
+
+class FixPropagate {
+public:
+    enum Order { FRACTIONALITY, LOCKS, LP_VALUE };
+
+    Order order=LOCKS;              // least fractional / most locked / largest LP value first
+    int max_backtracks=64;          // conflicts repaired per round() call
+    double work_factor=200;         // propagation visits per round() call, in nnz
+    double tol=1e-6;                // row feasibility tolerance
+
+    // last round() call
+    int fixes=0, propagated=0, conflicts=0, backtracks=0;
+
+    void init(const MipView& p){
+        P=&p;
+        lock.assign(p.n,0);
+        for(int j=0;j<p.n;j++){
+            int up=0, dn=0;
+            for(int q=p.cp[j];q<p.cp[j+1];q++){
+                int r=p.ri[q]; double a=p.cv[q];
+                bool hi=p.rhi[r]<MIP_INF, lo=p.rlo[r]>-MIP_INF;
+                if(a>0){ up+=hi; dn+=lo; } else { up+=lo; dn+=hi; }
+            }
+            lock[j]=std::max(up,dn);
+        }
+        // span_r = max |a_rj| (u_j - l_j) over the original domains; a row
+        // side with at least that much slack cannot tighten any column
+        span.assign(p.m,0);
+        for(int r=0;r<p.m;r++)
+            for(int q=p.rp[r];q<p.rp[r+1];q++){
+                int j=p.ci[q];
+                double w= fin(p.lb[j]) && fin(p.ub[j]) ? std::fabs(p.av[q])*(p.ub[j]-p.lb[j]) : MIP_INF;
+                span[r]=std::max(span[r],w);
+            }
+        ints.clear();
+        for(int j=0;j<p.n;j++) if(p.is_int[j]) ints.push_back(j);
+        lb.resize(p.n); ub.resize(p.n);
+        minact.resize(p.m); maxact.resize(p.m);
+        ninf_min.resize(p.m); ninf_max.resize(p.m);
+        in_queue.assign(p.m,0);
+        broken.assign(p.m,0);
+    }
+
+    bool round(const double* xlp, double threshold, std::vector<double>& xr){
+        const MipView& p=*P;
+        fixes=propagated=conflicts=backtracks=0;
+        work=0;
+        work_limit=(int64_t)(work_factor*p.nnz)+4096;
+        reset_domains();
+        sort_order(xlp,threshold);
+
+        bool clean=true;
+        for(int j:ints){
+            if(lb[j]==ub[j]) continue;
+            double v=clamp(j,round_int(xlp[j],threshold));
+            if(backtracks>=max_backtracks || work>work_limit){ lb[j]=ub[j]=v; continue; }
+            size_t mark=trail.size();
+            fixes++;
+            if(fix(j,v)) continue;
+            conflicts++;
+            undo(mark);
+            // the other integer next to xlp_j
+            double w=clamp(j, v>xlp[j] ? v-1 : v+1);
+            backtracks++;
+            if(w!=v){
+                if(fix(j,w)) continue;
+                undo(mark);
+            }
+            // both fail: keep the rounding, give up on the rows it breaks
+            clean=false;
+            set_bounds(j,v,v);
+            for(int q=p.cp[j];q<p.cp[j+1];q++) if(!row_ok(p.ri[q])) broken[p.ri[q]]=1;
+            clear_queue();
+        }
+        if(backtracks>=max_backtracks || work>work_limit) clean=false;
+
+        xr.resize(p.n);
+        for(int j=0;j<p.n;j++)
+            xr[j]= p.is_int[j] ? lb[j] : std::min(std::max(xlp[j],p.lb[j]),p.ub[j]);
+        return clean;
+    }
+
+private:
+    const MipView* P=nullptr;
+    std::vector<int> lock, ints;
+    std::vector<double> lb, ub, minact, maxact, span;
+    std::vector<int> ninf_min, ninf_max;
+    std::vector<unsigned char> in_queue, broken;
+    std::vector<int> queue;
+    struct Change { int j; double l, u; };
+    std::vector<Change> trail;
+    int64_t work=0, work_limit=0;
+
+    static bool fin(double v){ return std::fabs(v)<MIP_INF; }
+
+    double clamp(int j, double v) const { return std::min(std::max(v,lb[j]),ub[j]); }
+
+    static double round_int(double x, double threshold){
+        double f=std::floor(x);
+        return x-f>=threshold ? f+1 : f;
+    }
+
+    void reset_domains(){
+        const MipView& p=*P;
+        for(int j=0;j<p.n;j++){
+            lb[j]=p.lb[j]; ub[j]=p.ub[j];
+            if(p.is_int[j]){
+                if(fin(lb[j])) lb[j]=std::ceil(lb[j]-1e-9);
+                if(fin(ub[j])) ub[j]=std::floor(ub[j]+1e-9);
+            }
+        }
+        for(int r=0;r<p.m;r++){
+            double mn=0, mx=0; int im=0, iM=0;
+            for(int q=p.rp[r];q<p.rp[r+1];q++){
+                int j=p.ci[q]; double a=p.av[q];
+                double lo= a>0 ? lb[j] : ub[j], hi= a>0 ? ub[j] : lb[j];
+                if(fin(lo)) mn+=a*lo; else im++;
+                if(fin(hi)) mx+=a*hi; else iM++;
+            }
+            minact[r]=mn; maxact[r]=mx; ninf_min[r]=im; ninf_max[r]=iM;
+        }
+        std::fill(broken.begin(),broken.end(),0);
+        trail.clear();
+    }
+
+    void sort_order(const double* xlp, double threshold){
+        auto key=[&](int j)->double{
+            switch(order){
+            case LOCKS:    return -(double)lock[j];
+            case LP_VALUE: return -xlp[j];
+            default:       return std::fabs(xlp[j]-round_int(xlp[j],threshold));
+            }
+        };
+        std::sort(ints.begin(),ints.end(),[&](int a,int b){
+            double ka=key(a), kb=key(b);
+            return ka!=kb ? ka<kb : a<b;
+        });
+    }
+
+    // moves column j to [l, u] in the activities of its rows
+    void set_bounds(int j, double l, double u){
+        const MipView& p=*P;
+        trail.push_back({j,lb[j],ub[j]});
+        for(int q=p.cp[j];q<p.cp[j+1];q++){
+            int r=p.ri[q]; double a=p.cv[q];
+            double olo= a>0 ? lb[j] : ub[j], ohi= a>0 ? ub[j] : lb[j];
+            double nlo= a>0 ? l : u,         nhi= a>0 ? u : l;
+            if(olo!=nlo){
+                if(fin(olo)) minact[r]-=a*olo; else ninf_min[r]--;
+                if(fin(nlo)) minact[r]+=a*nlo; else ninf_min[r]++;
+            }
+            if(ohi!=nhi){
+                if(fin(ohi)) maxact[r]-=a*ohi; else ninf_max[r]--;
+                if(fin(nhi)) maxact[r]+=a*nhi; else ninf_max[r]++;
+            }
+            if(!in_queue[r]){ in_queue[r]=1; queue.push_back(r); }
+        }
+        lb[j]=l; ub[j]=u;
+    }
+
+    void undo(size_t mark){
+        while(trail.size()>mark){
+            Change c=trail.back();
+            set_bounds(c.j,c.l,c.u);
+            trail.pop_back();           // the entry set_bounds just pushed
+            trail.pop_back();
+        }
+        clear_queue();
+    }
+
+    void clear_queue(){
+        for(int r:queue) in_queue[r]=0;
+        queue.clear();
+    }
+
+    bool row_ok(int r) const {
+        const MipView& p=*P;
+        if(ninf_min[r]==0 && p.rhi[r]<MIP_INF && minact[r]>p.rhi[r]+tol*(1+std::fabs(p.rhi[r]))) return false;
+        if(ninf_max[r]==0 && p.rlo[r]>-MIP_INF && maxact[r]<p.rlo[r]-tol*(1+std::fabs(p.rlo[r]))) return false;
+        return true;
+    }
+
+    // x_j = v, then propagate to a fixpoint; false on a conflict
+    bool fix(int j, double v){
+        set_bounds(j,v,v);
+        bool ok=propagate();
+        clear_queue();
+        return ok;
+    }
+
+    bool propagate(){
+        const MipView& p=*P;
+        // long rows and continuous chains can make this expensive; past the
+        // work limit the remaining fixes are not propagated
+        for(size_t h=0;h<queue.size();h++){
+            int r=queue[h];
+            in_queue[r]=0;
+            if(broken[r]) continue;
+            if(!row_ok(r)) return false;
+            bool up=p.rhi[r]<MIP_INF && ninf_min[r]<=1, dn=p.rlo[r]>-MIP_INF && ninf_max[r]<=1;
+            if(up && ninf_min[r]==0 && p.rhi[r]-minact[r]>=span[r]) up=false;
+            if(dn && ninf_max[r]==0 && maxact[r]-p.rlo[r]>=span[r]) dn=false;
+            if(!up && !dn) continue;
+            for(int q=p.rp[r];q<p.rp[r+1];q++){
+                if(++work>work_limit) return true;
+                int j=p.ci[q];
+                if(lb[j]==ub[j]) continue;
+                double a=p.av[q];
+                double clo= a>0 ? lb[j] : ub[j], chi= a>0 ? ub[j] : lb[j];
+                double l=lb[j], u=ub[j];
+                // a x_j <= rhi - (min activity of the rest)
+                if(up){
+                    double res=0; bool ok;
+                    if(fin(clo)) { ok=ninf_min[r]==0; res=minact[r]-a*clo; }
+                    else         { ok=ninf_min[r]==1; res=minact[r]; }
+                    if(ok){
+                        double b=(p.rhi[r]-res)/a;
+                        if(a>0) u=std::min(u,b); else l=std::max(l,b);
+                    }
+                }
+                // a x_j >= rlo - (max activity of the rest)
+                if(dn){
+                    double res=0; bool ok;
+                    if(fin(chi)) { ok=ninf_max[r]==0; res=maxact[r]-a*chi; }
+                    else         { ok=ninf_max[r]==1; res=maxact[r]; }
+                    if(ok){
+                        double b=(p.rlo[r]-res)/a;
+                        if(a>0) l=std::max(l,b); else u=std::min(u,b);
+                    }
+                }
+                if(p.is_int[j]){
+                    if(fin(l)) l=std::ceil(l-1e-6);
+                    if(fin(u)) u=std::floor(u+1e-6);
+                } else {
+                    double w=1e-3*(1+(fin(lb[j]) && fin(ub[j]) ? ub[j]-lb[j] : 0));
+                    if(!(l>lb[j]+w)) l=lb[j];
+                    if(!(u<ub[j]-w)) u=ub[j];
+                }
+                if(l<=lb[j] && u>=ub[j]) continue;
+                l=std::max(l,lb[j]); u=std::min(u,ub[j]);
+                if(l>u+tol) return false;
+                if(l>u) l=u=p.is_int[j] ? std::round(0.5*(l+u)) : 0.5*(l+u);
+                set_bounds(j,l,u);
+                propagated++;
+            }
+        }
+        return true;
+    }
+};
@@ -2,14 +2,60 @@
 //
 // Compile:
 // nvcc fp2opt.cu -o fp2opt \
-//     -std=c++17 -O3 \
-//     -lOsiClp -lClp -lCoinUtils -lpthread
+//     -std=c++17 -O3 -Xcompiler -march=native,-fopenmp-simd \
+//     -lCbc -lCgl -lOsiClp -lClp -lOsi -lCoinUtils -lz -lpthread
 //
 // Usage:
-// ./fp2opt model.mps instance1 300
+// ./fp2opt model.mps instance1 300 [engine=auto|cpu|gpu] [threads=N] [batch=K]
+//          [pumps=N] [flip=T] [seed=S] [sol=bin|text|both] [relax=file]
+//          [trace=file.json] [presolve=on|off] [round=prop|plain]
+//          [order=frac|locks|lp] [backtracks=N] [fj=N] [fjtime=S]
+//          [reorder=off|rcm|auto] [cands=K] [lns=N] [lnstime=S]
+// (model.mps.gz is read directly; model.mipc from unzip_all is mapped instead
+//  of parsed whenever it exists)
+//
+// engine=auto runs 2-opt on the GPU when a CUDA device is present and on
+// the multithreaded CPU engine (two_opt_cpu.hpp) otherwise.
+// batch=K (default 64) applies a row-disjoint subset of the K best pair
+// moves and the improving single moves of every sweep together
+// (two_opt_batch.hpp); batch=1 applies one move per sweep.
+// pumps=N runs N diverse pump workers in threads that share the incumbent
+// (pump_portfolio.hpp); flip and seed set the perturbation.
+// round=prop (default) rounds by fix-and-propagate (fix_propagate.hpp):
+// integer columns are fixed in the given order (most locked first by
+// default, least fractional, or largest LP value; further pump workers
+// rotate through the orders) with bound propagation after every fix and
+// up to N (64) repaired conflicts per rounding. round=plain rounds every
+// column alone.
+// fj=N (default 4, 0 = off) first runs N feasibility-jump walkers
+// (feas_jump.hpp) for fjtime seconds (default min(10, time/10)), starting
+// from the rounded root point and from 0; their points go to the same
+// incumbent as the pump's, whose projection LPs then keep the objective
+// below it.
+// cands=K (default 1024, 0 = off) first scores K randomized roundings of
+// the root point in SpMM batches (batch_eval.hpp); feasible ones go to the
+// incumbent and the best ones replace the random start points of the jump
+// walkers beyond the first two.
+// lns=N (default 4, 0 = off) runs N sub-MIP neighbourhoods in threads
+// after the pump (lns.hpp): integer columns where the incumbent and the
+// root point agree (RINS), or where the root point is integral, are
+// fixed and the presolved rest is solved by Cbc with node and time
+// limits, for lnstime seconds in total (default min(60, time/4)).
+// relax=file starts the pump from a stored relaxation (cuOpt or Gurobi text,
+// or .msol; sol_reader.hpp) and skips the root LP solve.
+// A per-phase time table (prof.hpp) is printed at exit; trace=file also
+// writes a Chrome trace. Build with -DFP_PROF=0 to compile the timers out.
+// presolve=on (default) runs presolve.hpp first; the pump and 2-opt work on
+// the reduced model and every incumbent is postsolved before it is written.
+// reorder=rcm renumbers rows and columns of the working model in reverse
+// Cuthill-McKee order (mip_layout.hpp) for locality of the x gathers;
+// reorder=auto keeps it only if the simulated cache misses per nonzero
+// drop by 10%. Incumbents are mapped back before they are written.
 //
 // Produces solutions in:
-// solFiles/fp2Opt/instance1/incumbent_*.sol
+// solFiles/fp2Opt/instance1/incumbent_*.msol   (sparse binary, mip_sol.h)
+// solFiles/fp2Opt/instance1/incumbent_*.sol    (text, with sol=text|both)
+// written by a background thread (sol_writer.hpp).
 //
 
 #include <cstdio>
@@ -17,13 +63,13 @@
 #include <cstring>
 #include <vector>
 #include <string>
-#include <unordered_set>
 #include <chrono>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <iomanip>
 #include <cmath>
+#include <algorithm>
 
 #include <thrust/device_vector.h>
 #include <thrust/host_vector.h>
@@ -34,106 +80,87 @@
 #include "CoinPackedVector.hpp"
 #include "ClpSimplex.hpp"
 
+#include "mip_cache.hpp"
+#include "mip_osi.hpp"
+#include "ls_state.hpp"
+#include "feas_check.hpp"
+#include "pair_gen.hpp"
+#include "feas_jump.hpp"
+#include "batch_eval.hpp"
+#include "mip_layout.hpp"
+#include "presolve.hpp"
+#include "lns.hpp"
+#include "prof.hpp"
+#include "pump_portfolio.hpp"
+#include "sol_reader.hpp"
+#include "sol_writer.hpp"
+#include "two_opt.hpp"
+#include "two_opt_batch.hpp"
+#include "two_opt_cpu.hpp"
+
 // -------- CUDA CHECK ----------
 #define CUDA_CHECK(e) { if((e)!=cudaSuccess){ \
     fprintf(stderr,"CUDA: %s\n", cudaGetErrorString(e)); exit(1); }}
 
 // -------- DEVICE KERNELS ----------
 
-// Feasibility check: row-wise Ax <= b
-__global__ void check_feasible_csr_kernel(
-    int m, int n,
-    const int* __restrict__ rp,
-    const int* __restrict__ ci,
-    const double* __restrict__ av,
-    const double* __restrict__ x,
-    const double* __restrict__ rhs,
-    unsigned char* __restrict__ viol
-){
-    int r = blockIdx.x * blockDim.x + threadIdx.x;
-    if (r>=m) return;
-    int s=rp[r], e=rp[r+1];
-    double sum=0;
-    for(int k=s;k<e;k++) sum+=av[k]*x[ci[k]];
-    viol[r] = (sum > rhs[r] + 1e-8) ? 1 : 0;
-}
-
 // 2-opt improvement kernel
-struct MoveResult {
-    int mutex;
-    double delta;
-    int i,j,di,dj;
-};
-
-__global__ void two_opt_kernel(
-    int m, int n,
-    const int* __restrict__ rp,
-    const int* __restrict__ ci,
-    const double* __restrict__ av,
-    const double* __restrict__ cost,
-    const double* __restrict__ rhs,
+using MoveResult=mip_core::MoveResult<double>;
+
+// 2-opt over candidate pairs (pair_gen.hpp): one block per column i of a
+// degree bucket, threads stride over the neighbours j of i. Only moves
+// with di,dj != 0 are tried here; single moves and pairs without a shared
+// row come from best_combined_1opt on the host.
+#define PAIR_BS 256
+__global__ void two_opt_pairs_kernel(
+    int count,
+    const int* __restrict__ cols,
+    const int64_t* __restrict__ nb_ptr,
+    const int* __restrict__ nb,
+    mip_core::CoreModel<double,int> M,
     const double* __restrict__ x,
     const double* __restrict__ activity,
     MoveResult* best
 ){
-    int i=blockIdx.x, j=blockIdx.y;
-    if(i>=n||j>=n||i>=j) return;
-    if(threadIdx.x!=0) return;
-
-    double xi=x[i], xj=x[j];
-    double ci0=cost[i], cj0=cost[j];
-
-    for(int di=-1;di<=1;di++){
-        for(int dj=-1;dj<=1;dj++){
-            if(!di && !dj) continue;
-            double newXi=xi+di,newXj=xj+dj;
-            double d= ci0*di + cj0*dj;
-            if(d>=best->delta) continue;
-
-            bool feas=true;
-            for(int r=0;r<m;r++){
-                int s=rp[r],e=rp[r+1];
-                double ai=0,aj=0;
-                for(int k=s;k<e;k++){
-                    int col=ci[k];
-                    if(col==i) ai=av[k];
-                    if(col==j) aj=av[k];
-                }
-                double sum = activity[r] + ai*di + aj*dj;
-                if(sum > rhs[r]+1e-8){ feas=false; break; }
-            }
-            if(!feas) continue;
-
-            // lock & update
-            while(atomicExch(&best->mutex,1)!=0);
-            if(d<best->delta){
-                best->delta=d;
-                best->i=i; best->j=j;
-                best->di=di; best->dj=dj;
-            }
-            best->mutex=0;
-        }
+    __shared__ MoveResult s[PAIR_BS];
+    int i=cols[blockIdx.x];
+
+    MoveResult mv={0,0.0,-1,-1,0,0};
+    for(int64_t q=nb_ptr[i]+threadIdx.x;q<nb_ptr[i+1];q+=blockDim.x){
+        double bound=mv.delta<best->delta?mv.delta:best->delta;
+        mip_core::best_move_of_pair(M,x,activity,i,nb[q],1e-8,bound,mv);
     }
+    mip_core::block_offer_move(s,mv,best);
 }
 
-// -------- CPU UTILS ----------
-
-void write_sol(const std::string& inst,int id,const std::vector<double>& x,double obj){
-    std::string dir="solFiles/fp2Opt/"+inst;
-    system(("mkdir -p "+dir).c_str());
-    std::ofstream f(dir+"/incumbent_"+std::to_string(id)+".sol");
-    f<<"obj: "<<obj<<"\n";
-    for(size_t i=0;i<x.size();i++) f<<"x"<<i<<" "<<x[i]<<"\n";
-    f.close();
+// Sparse host->device update: dst[idx[k]] = val[k]
+__global__ void scatter_kernel(int k, const int* __restrict__ idx, const double* __restrict__ val, double* __restrict__ dst){
+    int t = blockIdx.x * blockDim.x + threadIdx.x;
+    if (t<k) dst[idx[t]] = val[t];
 }
 
-std::string hash_round(const std::vector<double>& x){
-    std::ostringstream o; o<<std::fixed<<std::setprecision(0);
-    for(double v:x) o<<v<<",";
-    return o.str();
+// -------- CPU UTILS ----------
+
+// Pushes src[idx] for the given indices into d_dst through one staging copy.
+void push_dirty(const std::vector<int>& idx, const std::vector<double>& src,
+                thrust::device_vector<int>& d_idx, thrust::device_vector<double>& d_val,
+                thrust::device_vector<double>& d_dst){
+    int k=(int)idx.size();
+    if(!k) return;
+    PROF_SCOPE("h2d.push");
+    if((int)d_idx.size()<k){ d_idx.resize(k); d_val.resize(k); }
+    std::vector<double> val(k);
+    for(int t=0;t<k;t++) val[t]=src[idx[t]];
+    CUDA_CHECK(cudaMemcpy(thrust::raw_pointer_cast(d_idx.data()),idx.data(),k*sizeof(int),cudaMemcpyHostToDevice));
+    CUDA_CHECK(cudaMemcpy(thrust::raw_pointer_cast(d_val.data()),val.data(),k*sizeof(double),cudaMemcpyHostToDevice));
+    scatter_kernel<<<(k+255)/256,256>>>(k,
+        thrust::raw_pointer_cast(d_idx.data()),
+        thrust::raw_pointer_cast(d_val.data()),
+        thrust::raw_pointer_cast(d_dst.data()));
 }
 
 bool solve_lp(OsiClpSolverInterface& s,std::vector<double>& x,double& obj){
+    PROF_SCOPE("root.lp");
     s.initialSolve();
     if(s.isProvenPrimalInfeasible()) return false;
     int n=s.getNumCols();
@@ -142,170 +169,422 @@ bool solve_lp(OsiClpSolverInterface& s,std::vector<double>& x,double& obj){
     return true;
 }
 
-void csr_from_mps(const CoinPackedMatrix* M,std::vector<int>& rp,std::vector<int>& ci,std::vector<double>& av){
-    int m=M->getNumRows();
-    rp.resize(m+1);
-    int nz=0;
-    for(int r=0;r<m;r++){
-        rp[r]=nz;
-        auto row=M->getVector(r);
-        for(int k=0;k<row.getNumElements();k++){
-            ci.push_back(row.getIndices()[k]);
-            av.push_back(row.getElements()[k]);
-            nz++;
+// -------- OPTIONS ----------
+
+struct Options {
+    int limit=300;
+    std::string engine="auto";      // auto | cpu | gpu
+    int threads=0;                  // 0 = all hardware threads
+    int batch=64;                   // moves collected per 2-opt sweep
+    int pumps=1;                    // pump workers (portfolio when > 1)
+    int flip=20;                    // pump: T for short-cycle flips
+    unsigned seed=1;                // pump: perturbation seed
+    int sol=SolWriter::BIN;         // incumbent files: bin | text | both
+    std::string relax;              // stored relaxation to start the pump from
+    std::string trace;              // Chrome trace output
+    bool presolve=true;
+    bool propagate=true;            // round=prop | plain
+    int order=FixPropagate::LOCKS;
+    int backtracks=64;
+    int fj=4;                       // feasibility-jump walkers (0 = off)
+    std::string reorder="off";      // off | rcm | auto
+    double fjtime=-1;               // seconds; < 0 = min(10, limit/10)
+    int cands=1024;                 // scored roundings of the root point (0 = off)
+    int lns=4;                      // sub-MIP workers after the pump (0 = off)
+    double lnstime=-1;              // seconds; < 0 = min(60, limit/4)
+};
+
+// [time] then key=value pairs
+bool parse_options(int argc,char** argv,int first,Options& o){
+    for(int a=first;a<argc;a++){
+        std::string arg=argv[a];
+        size_t eq=arg.find('=');
+        if(eq==std::string::npos){
+            if(a!=first) return false;
+            o.limit=atoi(arg.c_str());
+            continue;
         }
+        std::string k=arg.substr(0,eq), v=arg.substr(eq+1);
+        if(k=="time") o.limit=atoi(v.c_str());
+        else if(k=="engine" && (v=="auto"||v=="cpu"||v=="gpu")) o.engine=v;
+        else if(k=="threads") o.threads=atoi(v.c_str());
+        else if(k=="batch" && atoi(v.c_str())>=1) o.batch=atoi(v.c_str());
+        else if(k=="pumps" && atoi(v.c_str())>=1) o.pumps=atoi(v.c_str());
+        else if(k=="flip" && atoi(v.c_str())>=1) o.flip=atoi(v.c_str());
+        else if(k=="seed") o.seed=(unsigned)strtoul(v.c_str(),nullptr,10);
+        else if(k=="sol" && v=="bin") o.sol=SolWriter::BIN;
+        else if(k=="sol" && v=="text") o.sol=SolWriter::TEXT;
+        else if(k=="sol" && v=="both") o.sol=SolWriter::BOTH;
+        else if(k=="relax") o.relax=v;
+        else if(k=="trace") o.trace=v;
+        else if(k=="presolve" && (v=="on"||v=="off")) o.presolve=v=="on";
+        else if(k=="round" && (v=="prop"||v=="plain")) o.propagate=v=="prop";
+        else if(k=="order" && v=="frac") o.order=FixPropagate::FRACTIONALITY;
+        else if(k=="order" && v=="locks") o.order=FixPropagate::LOCKS;
+        else if(k=="order" && v=="lp") o.order=FixPropagate::LP_VALUE;
+        else if(k=="backtracks" && atoi(v.c_str())>=0) o.backtracks=atoi(v.c_str());
+        else if(k=="fj" && atoi(v.c_str())>=0) o.fj=atoi(v.c_str());
+        else if(k=="fjtime" && atof(v.c_str())>=0) o.fjtime=atof(v.c_str());
+        else if(k=="cands" && atoi(v.c_str())>=0) o.cands=atoi(v.c_str());
+        else if(k=="lns" && atoi(v.c_str())>=0) o.lns=atoi(v.c_str());
+        else if(k=="lnstime" && atof(v.c_str())>=0) o.lnstime=atof(v.c_str());
+        else if(k=="reorder" && (v=="off"||v=="rcm"||v=="auto")) o.reorder=v;
+        else return false;
     }
-    rp[m]=nz;
+    return true;
 }
 
-// -------- MAIN ----------
-
-int main(int argc,char**argv){
-    if(argc<3){ printf("usage: ./fp2opt file.mps instance [time=300]\n"); return 1; }
-    std::string file=argv[1], inst=argv[2];
-    int LIMIT = (argc>3?atoi(argv[3]):300);
-    auto t0=std::chrono::steady_clock::now();
+bool cuda_available(){
+    int nd=0;
+    return cudaGetDeviceCount(&nd)==cudaSuccess && nd>0;
+}
 
-    OsiClpSolverInterface s;
-    if(s.readMps(file.c_str())){ printf("MPS read error\n"); return 1; }
+// Incumbents of the (possibly presolved and reordered) working model,
+// written in the original space. shift = offset difference, objectives
+// exclude offsets.
+struct IncumbentOut {
+    SolWriter& w;
+    const Presolved* pre=nullptr;
+    double shift=0;
+    const MatrixOrder* ord=nullptr;
+    void submit(int id,const std::vector<double>& x,double obj,const char* source){
+        if(ord){ put(id,ord->to_original(x),obj,source); return; }
+        put(id,x,obj,source);
+    }
+    void put(int id,const std::vector<double>& x,double obj,const char* source){
+        if(pre) w.submit(id,pre->postsolve(x),obj+shift,source);
+        else    w.submit(id,x,obj,source);
+    }
+};
 
-    int m=s.getNumRows(), n=s.getNumCols();
-    auto A=s.getMatrixByRow();
-    const double* rhs=s.getRightHandSide();
-    const double* obj=s.getObjCoefficients();
-    const double* lb=s.getColLower();
-    const double* ub=s.getColUpper();
+// -------- 2-OPT DRIVERS ----------
+// Both descend from the incumbent in ls until no improving move is left or
+// the time limit is hit, writing every improvement.
 
-    std::vector<int> rp,ci;
-    std::vector<double> av;
-    csr_from_mps(A,rp,ci,av);
+double elapsed(std::chrono::steady_clock::time_point t0){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
+}
 
-    thrust::device_vector<int> d_rp=rp, d_ci=ci;
-    thrust::device_vector<double> d_av=av;
-    thrust::device_vector<double> d_rhs(rhs,rhs+m);
-    thrust::device_vector<double> d_obj(obj,obj+n);
+void two_opt_cpu(const MipView& P,const CandidatePairs& C,LsState& ls,const Options& o,
+                 IncumbentOut& out,double& inc_obj,int& inc_id,
+                 std::chrono::steady_clock::time_point t0){
+    PROF_SCOPE("2opt.cpu");
+    TwoOptEngine E(P,C,o.threads);
+    std::vector<TwoOptMove> cand, batch;
+    std::vector<unsigned char> row_stamp, col_stamp;
+    while(elapsed(t0)<=o.limit){
+        if(o.batch>1){
+            E.best_moves(ls.x.data(),ls.act.data(),o.batch,cand);
+            select_independent(P,cand,batch,row_stamp,col_stamp);
+            if(batch.empty()) break;
+            apply_batch(ls,batch);
+        } else {
+            TwoOptMove mv=E.best_move(ls.x.data(),ls.act.data());
+            if(mv.i<0 || mv.delta>=0) break;
+            apply_move(ls,mv);
+            PROF_COUNT("2opt.applied",1);
+        }
+        ls.clear_dirty();
+        if(ls.objv<inc_obj){
+            inc_obj=ls.objv; inc_id++;
+            out.submit(inc_id,ls.x,inc_obj,"2opt");
+        }
+    }
+}
 
-    // ---- FP Start ----
-    std::vector<double> xlp; double lpobj;
-    if(!solve_lp(s,xlp,lpobj)){ printf("LP infeasible\n"); return 0; }
+void two_opt_gpu(const MipView& P,const CandidatePairs& C,LsState& ls,const Options& o,
+                 IncumbentOut& out,double& inc_obj,int& inc_id,
+                 std::chrono::steady_clock::time_point t0){
+    PROF_SCOPE("2opt.gpu");
+    int m=P.m, n=P.n;
+    thrust::device_vector<int> d_cp(P.cp,P.cp+n+1), d_ri(P.ri,P.ri+P.nnz);
+    thrust::device_vector<double> d_cv(P.cv,P.cv+P.nnz);
+    thrust::device_vector<double> d_lb(P.lb,P.lb+n), d_ub(P.ub,P.ub+n);
+    thrust::device_vector<double> d_rlo(P.rlo,P.rlo+m), d_rhi(P.rhi,P.rhi+m);
+    thrust::device_vector<double> d_obj(P.obj,P.obj+n);
+    thrust::device_vector<int> d_order=C.order, d_nb=C.nb;
+    thrust::device_vector<int64_t> d_nbptr=C.ptr;
+    // device arrays; the 2-opt kernel reads the CSC side only
+    mip_core::CoreModel<double,int> M;
+    M.m=m; M.n=n;
+    M.csc={n,thrust::raw_pointer_cast(d_cp.data()),thrust::raw_pointer_cast(d_ri.data()),
+           thrust::raw_pointer_cast(d_cv.data())};
+    M.obj=thrust::raw_pointer_cast(d_obj.data());
+    M.lb=thrust::raw_pointer_cast(d_lb.data()); M.ub=thrust::raw_pointer_cast(d_ub.data());
+    M.rlo=thrust::raw_pointer_cast(d_rlo.data()); M.rhi=thrust::raw_pointer_cast(d_rhi.data());
+
+    // activity/objective/violation are kept incrementally on the host;
+    // only rows and columns touched by a move are pushed to the device
+    thrust::device_vector<double> d_ix=ls.x;
+    thrust::device_vector<double> d_act=ls.act;
+    thrust::device_vector<int> d_pidx(1024);
+    thrust::device_vector<double> d_pval(1024);
 
-    std::unordered_set<std::string> seen;
-    int it=0, inc_id=0;
-    double inc_obj=1e100;
-    std::vector<double> inc_x(n);
+    MoveResult init={0,0.0,-1,-1,0,0};
+    thrust::device_vector<MoveResult> d_best(1,init);
 
-    thrust::device_vector<double> d_x(n);
-    thrust::device_vector<unsigned char> d_v(m);
+    TopMoves top(2*n+1);
+    std::vector<TwoOptMove> batch;
+    std::vector<unsigned char> row_stamp, col_stamp;
 
     while(true){
-        it++;
-        double T = std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
-        if(T>LIMIT) break;
-
-        // rounding
-        std::vector<double> xr(n);
-        for(int i=0;i<n;i++){
-            double v=round(xlp[i]);
-            if(v<lb[i]) v=lb[i];
-            if(v>ub[i]) v=ub[i];
-            xr[i]=v;
-        }
-        std::string h=hash_round(xr);
-        if(seen.count(h)) break;
-        seen.insert(h);
-
-        thrust::copy(xr.begin(),xr.end(),d_x.begin());
-        int BS=256,GS=(m+BS-1)/BS;
-        check_feasible_csr_kernel<<<GS,BS>>>(m,n,
-            thrust::raw_pointer_cast(d_rp.data()),
-            thrust::raw_pointer_cast(d_ci.data()),
-            thrust::raw_pointer_cast(d_av.data()),
-            thrust::raw_pointer_cast(d_x.data()),
-            thrust::raw_pointer_cast(d_rhs.data()),
-            thrust::raw_pointer_cast(d_v.data()));
-        cudaDeviceSynchronize();
-
-        std::vector<unsigned char> hv(m);
-        thrust::copy(d_v.begin(),d_v.end(),hv.begin());
-        bool feas=true;
-        for(auto &z:hv){ if(z){feas=false;break;} }
-
-        double xr_obj=0; for(int i=0;i<n;i++) xr_obj+=obj[i]*xr[i];
-        if(feas){
-            if(xr_obj<inc_obj){
-                inc_obj=xr_obj; inc_x=xr; inc_id++;
-                write_sol(inst,inc_id,inc_x,inc_obj);
+        MoveResult zero={0,0.0,-1,-1,0,0};
+        cudaMemcpy(thrust::raw_pointer_cast(d_best.data()),&zero,sizeof(zero),cudaMemcpyHostToDevice);
+
+        {
+            PROF_SCOPE("2opt.gpu_sweep");
+            PROF_COUNT("2opt.pairs_scanned",C.num_pairs());
+            for(size_t b=0;b+1<C.bucket_ptr.size();b++){
+                int c0=C.bucket_ptr[b], cnt=C.bucket_ptr[b+1]-c0;
+                if(cnt<=0) continue;
+                int bs=std::min(PAIR_BS,std::max(32,1<<b));
+                two_opt_pairs_kernel<<<cnt,bs>>>(cnt,
+                    thrust::raw_pointer_cast(d_order.data())+c0,
+                    thrust::raw_pointer_cast(d_nbptr.data()),
+                    thrust::raw_pointer_cast(d_nb.data()),
+                    M,
+                    thrust::raw_pointer_cast(d_ix.data()),
+                    thrust::raw_pointer_cast(d_act.data()),
+                    thrust::raw_pointer_cast(d_best.data())
+                );
             }
-            break;
+            CUDA_CHECK(cudaDeviceSynchronize());
         }
 
-        // projection LP: simple objective replace
-      ClpSimplex *model = s.getModelPtr();
-for(int i = 0; i < n; i++){
-    model->setObjectiveCoefficient(i, fabs(xlp[i] - xr[i]));
-}
+        MoveResult br;
+        {
+            PROF_SCOPE("d2h.best");
+            cudaMemcpy(&br, thrust::raw_pointer_cast(d_best.data()),sizeof(br),cudaMemcpyDeviceToHost);
+        }
+
+        TwoOptMove gm;
+        if(br.i>=0){ gm.i=br.i; gm.j=br.j; gm.di=br.di; gm.dj=br.dj; gm.delta=br.delta; }
+        if(o.batch>1){
+            // the device reports one pair; the improving single moves from
+            // the host fill up the batch around it
+            top.clear();
+            if(gm.i>=0) top.offer(gm);
+            {
+                PROF_SCOPE("2opt.one_opt");
+                one_opt_scan(P,ls.x.data(),ls.act.data(),C,top);
+            }
+            select_independent(P,top.sorted(),batch,row_stamp,col_stamp);
+            if(batch.empty()) break;
+            apply_batch(ls,batch);
+        } else {
+            // single moves and non-interacting pairs on the host
+            TwoOptMove hm; hm.delta=(gm.i>=0?gm.delta:0.0);
+            {
+                PROF_SCOPE("2opt.one_opt");
+                best_combined_1opt(P,ls.x.data(),ls.act.data(),C,hm);
+            }
+            if(hm.i>=0) gm=hm;
+            if(gm.i<0 || gm.delta>=0) break;
+            apply_move(ls,gm);
+            PROF_COUNT("2opt.applied",1);
+        }
+        if(ls.objv<inc_obj){
+            inc_obj=ls.objv; inc_id++;
+            out.submit(inc_id,ls.x,inc_obj,"2opt");
+        }
 
-        s.initialSolve();
-if(s.isProvenPrimalInfeasible()) break;
-xlp.assign(s.getColSolution(), s.getColSolution() + n);
-lpobj = s.getObjValue();
+        push_dirty(ls.dirty_rows,ls.act,d_pidx,d_pval,d_act);
+        push_dirty(ls.dirty_cols,ls.x,d_pidx,d_pval,d_ix);
+        ls.clear_dirty();
 
+        if(elapsed(t0)>o.limit) break;
     }
+}
 
-    if(inc_id==0){ printf("no feasible integer found\n"); return 0; }
+// -------- MAIN ----------
 
-    // ---- 2-OPT ----
-    thrust::device_vector<double> d_ix=inc_x;
-    std::vector<double> act(m,0);
-    for(int r=0;r<m;r++){
-        double sum=0; for(int k=rp[r];k<rp[r+1];k++) sum+=av[k]*inc_x[ci[k]];
-        act[r]=sum;
+// per-phase table (and trace) when main returns, after the writer thread
+// has finished
+struct ProfReport {
+    std::string trace;
+    ~ProfReport(){
+        prof::print_summary(stdout);
+        if(!trace.empty() && !prof::write_chrome_trace(trace.c_str()))
+            printf("cannot write %s\n",trace.c_str());
     }
-    thrust::device_vector<double> d_act=act;
+};
 
-    MoveResult init={0,0.0,-1,-1,0,0};
-    thrust::device_vector<MoveResult> d_best(1,init);
+int main(int argc,char**argv){
+    Options opt;
+    if(argc<3 || !parse_options(argc,argv,3,opt)){
+        printf("usage: ./fp2opt file.mps instance [time=300] [engine=auto|cpu|gpu] [threads=N] [batch=K] [pumps=N] [flip=T] [seed=S] [sol=bin|text|both] [relax=file] [trace=file.json] [presolve=on|off] [round=prop|plain] [order=frac|locks|lp] [backtracks=N] [fj=N] [fjtime=S] [reorder=off|rcm|auto] [cands=K] [lns=N] [lnstime=S]\n");
+        return 1;
+    }
+    std::string file=argv[1], inst=argv[2];
+    int LIMIT = opt.limit;
+    auto t0=std::chrono::steady_clock::now();
+    ProfReport report{opt.trace};
 
-    while(true){
-        MoveResult zero={0,0.0,-1,-1,0,0};
-        cudaMemcpy(thrust::raw_pointer_cast(d_best.data()),&zero,sizeof(zero),cudaMemcpyHostToDevice);
+    MipInstance I; std::string err;
+    {
+        PROF_SCOPE("load");
+        if(!I.open(file,&err)){ printf("MPS read error: %s\n",err.c_str()); return 1; }
+    }
+    const MipView& P0=I.view;
+
+    // reduced model, or the original one when presolve is off or fails
+    Presolved pre;
+    bool use_pre=false;
+    if(opt.presolve){
+        PROF_SCOPE("presolve");
+        PresolveOptions po; po.threads=opt.threads;
+        if(presolve(P0,pre,po)){
+            const PresolveStats& st=pre.stats;
+            printf("Presolve: %dx%d -> %dx%d in %d rounds (%d bounds tightened, %d fixed, %d singleton rows, "
+                   "%d redundant rows, %d duplicate rows, %d singleton cols, %d parallel cols)\n",
+                   P0.m,P0.n,pre.model.m,pre.model.n,st.rounds,st.tightened,st.fixed+st.empty_cols,
+                   st.singleton_rows,st.redundant_rows+st.empty_rows,st.dup_rows,st.singleton_cols,st.parallel_cols);
+            use_pre=true;
+        } else printf("Presolve: model infeasible, continuing on the original model\n");
+    }
+    MipView PV=use_pre ? pre.model.view() : P0;
+    SolWriter writer("solFiles/fp2Opt/"+inst,opt.sol);
+    IncumbentOut out{writer,use_pre?&pre:nullptr,use_pre?pre.model.obj_offset-P0.obj_offset:0.0};
+
+    // working model renumbered for locality (reorder=rcm|auto)
+    MatrixOrder ord;
+    MipProblem RP;
+    bool use_ord=false;
+    if(opt.reorder!="off" && PV.n>0){
+        PROF_SCOPE("reorder");
+        ord=rcm_order(PV);
+        permute_model(PV,ord,RP);
+        GatherStats g0=gather_stats(PV), g1=gather_stats(RP.view());
+        use_ord= opt.reorder=="rcm" || g1.misses_per_nnz<0.9*g0.misses_per_nnz;
+        printf("Reorder (RCM): mean row span %.0f -> %.0f, est. x misses/nnz %.4f -> %.4f%s\n",
+               g0.mean_span,g1.mean_span,g0.misses_per_nnz,g1.misses_per_nnz,use_ord?"":", kept original order");
+        if(use_ord){ PV=RP.view(); out.ord=&ord; }
+    }
+    const MipView& P=PV;
+    if(P.n==0){
+        // everything fixed by presolve
+        std::vector<double> x;
+        out.submit(1,x,0.0,"presolve");
+        writer.flush();
+        printf("Done. Best obj = %.10f, incumbents = 1 (solved by presolve)\n",out.shift);
+        return 0;
+    }
 
-        dim3 G(n,n),B(1);
-        two_opt_kernel<<<G,B>>>(m,n,
-            thrust::raw_pointer_cast(d_rp.data()),
-            thrust::raw_pointer_cast(d_ci.data()),
-            thrust::raw_pointer_cast(d_av.data()),
-            thrust::raw_pointer_cast(d_obj.data()),
-            thrust::raw_pointer_cast(d_rhs.data()),
-            thrust::raw_pointer_cast(d_ix.data()),
-            thrust::raw_pointer_cast(d_act.data()),
-            thrust::raw_pointer_cast(d_best.data())
-        );
-        cudaDeviceSynchronize();
+    OsiClpSolverInterface s;
+    {
+        PROF_SCOPE("lp.build");
+        load_osi(s,P);
+    }
 
-        MoveResult br;
-        cudaMemcpy(&br, thrust::raw_pointer_cast(d_best.data()),sizeof(br),cudaMemcpyDeviceToHost);
-        if(br.i<0 || br.delta>=0) break;
-
-        inc_x[br.i]+=br.di;
-        inc_x[br.j]+=br.dj;
-        double newObj=0; for(int i=0;i<n;i++) newObj+=obj[i]*inc_x[i];
-        if(newObj<inc_obj){
-            inc_obj=newObj; inc_id++;
-            write_sol(inst,inc_id,inc_x,inc_obj);
+    // ---- FP Start ----
+    // root point: a stored relaxation (relax=file) or the Clp root LP
+    std::vector<double> xlp; double lpobj;
+    bool have_root=false;
+    if(!opt.relax.empty()){
+        PROF_SCOPE("root.relax");
+        LoadedSol R;
+        if(load_solution(opt.relax,P0,R,&err)){
+            xlp = use_pre ? pre.reduce(R.x) : R.x;
+            if(use_ord) xlp=ord.to_reordered(xlp);
+            for(int j=0;j<P.n;j++) xlp[j]=std::min(std::max(xlp[j],P.lb[j]),P.ub[j]);
+            have_root=true;
+            printf("Root from %s (%lld values, %lld unmatched), root LP skipped\n",
+                   opt.relax.c_str(),(long long)R.entries,(long long)R.unmatched);
+        } else printf("cannot load %s: %s, solving the root LP\n",opt.relax.c_str(),err.c_str());
+    }
+    if(!have_root && !solve_lp(s,xlp,lpobj)){ printf("LP infeasible\n"); return 0; }
+
+    // jump walkers, then N pump workers (one by default), all sharing the
+    // incumbent; every improvement is written as it is found
+    SharedIncumbent inc([&](const std::vector<double>& x,double o,int id,const char* src){
+        out.submit(id,x,o,src);
+    });
+    auto deadline=t0+std::chrono::seconds(LIMIT);
+    std::vector<std::vector<double>> starts=fj_starts(P,xlp,opt.fj,opt.seed);
+    if(opt.cands>0){
+        PROF_SCOPE("round.batch");
+        auto c0=std::chrono::steady_clock::now();
+        BatchEval E; E.init(P);
+        std::vector<Candidate> best=E.best_roundings(xlp,opt.cands,std::max(1,opt.fj-2),opt.seed);
+        for(const Candidate& c:best)
+            if(c.score.feasible() && is_feasible(P,c.x.data())) inc.offer(c.x,c.score.obj,"round");
+        for(size_t k=2;k<starts.size() && k-2<best.size();k++) starts[k]=best[k-2].x;
+        double dt=std::chrono::duration<double>(std::chrono::steady_clock::now()-c0).count();
+        printf("Rounding: %lld candidates in %.3f s, %lld feasible, best ",(long long)E.evaluated,dt,(long long)E.feasible);
+        if(best[0].score.feasible()) printf("obj %.10f\n",best[0].score.obj+out.shift);
+        else printf("violation %g in %d rows\n",best[0].score.viol,best[0].score.violated);
+    }
+    if(opt.fj>0){
+        double ft= opt.fjtime>=0 ? opt.fjtime : std::min(10.0,LIMIT/10.0);
+        auto fj_end=std::min(deadline,std::chrono::steady_clock::now()+
+                             std::chrono::milliseconds((long long)(ft*1000)));
+        FjConfig fc; fc.seed=opt.seed;
+        std::vector<FjStats> fs=run_feas_jump(P,starts,fc,inc,fj_end);
+        long long moves=0, bumps=0; double first=-1;
+        for(const FjStats& f:fs){
+            moves+=f.moves; bumps+=f.bumps;
+            if(f.first_feasible>=0 && (first<0 || f.first_feasible<first)) first=f.first_feasible;
         }
+        printf("FJ: %d walkers, %lld moves, %lld weight updates, ",(int)fs.size(),moves,bumps);
+        if(first>=0) printf("first feasible after %.3f s, best obj %.10f\n",first,inc.cutoff()+out.shift);
+        else         printf("no feasible point\n");
+    }
+    std::vector<PumpConfig> cfg=portfolio_configs(opt.pumps,opt.seed,opt.flip);
+    for(size_t k=0;k<cfg.size();k++){
+        cfg[k].propagate=opt.propagate;
+        cfg[k].order=(FixPropagate::Order)((opt.order+k)%3);
+        cfg[k].backtracks=opt.backtracks;
+    }
+    std::vector<PumpStats> ps=run_pump_portfolio(P,s,xlp,cfg,inc,deadline);
 
-        for(int r=0;r<m;r++){
-            double s2=0; for(int k=rp[r];k<rp[r+1];k++) s2+=av[k]*inc_x[ci[k]];
-            act[r]=s2;
+    PumpStats tot;
+    for(const PumpStats& p:ps){
+        tot.iters+=p.iters; tot.flips+=p.flips; tot.restarts+=p.restarts; tot.lp_iters+=p.lp_iters;
+        tot.clean+=p.clean;
+        if(p.found) tot.found_iter=p.found_iter;
+    }
+    printf("Pump: %d workers, %d iterations (%d cleanly propagated), %d flips, %d restarts, %lld LP iterations\n",
+           (int)ps.size(),tot.iters,tot.clean,tot.flips,tot.restarts,tot.lp_iters);
+    if(tot.found_iter) printf("Pump: best point found in iteration %d%s\n",tot.found_iter,
+                              tot.found_iter==1?" (no projection LP)":"");
+    if(opt.lns>0){
+        double lt= opt.lnstime>=0 ? opt.lnstime : std::min(60.0,LIMIT/4.0);
+        auto lns_end=std::min(deadline,std::chrono::steady_clock::now()+
+                              std::chrono::milliseconds((long long)(lt*1000)));
+        LnsConfig lc; lc.workers=opt.lns; lc.seed=opt.seed;
+        std::vector<LnsStats> lr=run_lns(P,xlp,lc,inc,lns_end);
+        LnsStats t;
+        for(const LnsStats& l:lr){
+            t.solved+=l.solved; t.improved+=l.improved; t.skipped+=l.skipped; t.infeasible+=l.infeasible;
+            t.rows+=l.rows; t.cols+=l.cols;
         }
-        thrust::copy(act.begin(),act.end(),d_act.begin());
-        thrust::copy(inc_x.begin(),inc_x.end(),d_ix.begin());
+        int built=t.solved+t.infeasible;
+        printf("LNS: %d sub-MIPs (%d improved), %d skipped, %d infeasible",t.solved,t.improved,t.skipped,t.infeasible);
+        if(built) printf(", mean size %.1f%% rows %.1f%% cols",100*t.rows/built,100*t.cols/built);
+        if(inc.has()) printf(", best obj %.10f",inc.cutoff()+out.shift);
+        printf("\n");
+    }
+    if(!inc.has()){ printf("no feasible integer found\n"); return 0; }
+    int inc_id=inc.id();
+    double inc_obj=inc.cutoff();
+    const std::vector<double>& inc_x=inc.x();
 
-        double T = std::chrono::duration<double>(std::chrono::steady_clock::now()-t0).count();
-        if(T>LIMIT) break;
+    // ---- 2-OPT ----
+    LsState ls; ls.init(P,inc_x.data());
+
+    // candidate pairs from the constraint graph instead of an n x n grid
+    CandidatePairs C;
+    {
+        PROF_SCOPE("pairs.build");
+        build_candidate_pairs(P,C);
     }
 
-    printf("Done. Best obj = %.10f, incumbents = %d\n",inc_obj,inc_id);
+    bool gpu = opt.engine=="gpu" || (opt.engine=="auto" && cuda_available());
+    if(gpu) two_opt_gpu(P,C,ls,opt,out,inc_obj,inc_id,t0);
+    else    two_opt_cpu(P,C,ls,opt,out,inc_obj,inc_id,t0);
+
+    writer.flush();
+    printf("Done. Best obj = %.10f, incumbents = %d (%zu written, %zu superseded in the queue)\n",
+           inc_obj+out.shift,inc_id,writer.written(),writer.dropped());
     return 0;
 }
@@ -0,0 +1,51 @@
+// incumbent.hpp  (header-only)
+//
+// Best known point shared by heuristic threads (pump workers, jump
+// walkers). The objective is an atomic cutoff read without locking; a
+// point is only published when it improves, and the callback (e.g. the
+// solution writer) sees improvements in order.
+//
+//   SharedIncumbent inc(on_improve);
+//   if(obj < inc.cutoff()) inc.offer(x, obj, "fj");
+//
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+class SharedIncumbent {
+public:
+    using Callback=std::function<void(const std::vector<double>& x, double obj, int id, const char* source)>;
+
+    explicit SharedIncumbent(Callback cb=nullptr) : cb_(std::move(cb)) {}
+
+    double cutoff() const { return obj_.load(std::memory_order_acquire); }
+    bool has() const { return cutoff()<INF; }
+
+    // Publishes (x, obj) if it improves; cb runs under the lock, so
+    // improvements are reported in order.
+    bool offer(const std::vector<double>& x, double obj, const char* source="fp"){
+        if(obj>=cutoff()) return false;
+        std::lock_guard<std::mutex> g(mu_);
+        if(obj>=obj_.load(std::memory_order_relaxed)) return false;
+        x_=x; id_++;
+        obj_.store(obj,std::memory_order_release);
+        if(cb_) cb_(x_,obj,id_,source);
+        return true;
+    }
+
+    // valid once the workers have finished
+    const std::vector<double>& x() const { return x_; }
+    int id() const { return id_; }
+
+private:
+    static constexpr double INF=1e100;
+    std::atomic<double> obj_{INF};
+    std::mutex mu_;
+    std::vector<double> x_;
+    int id_=0;
+    Callback cb_;
+};
@@ -0,0 +1,195 @@
+// lns.hpp  (header-only, needs Cbc/Cgl/Osi/Clp, link with -lpthread)
+//
+// Large-neighbourhood search with sub-MIPs. A neighbourhood fixes integer
+// columns of the model and leaves the rest to Cbc:
+//
+//   RINS    columns on which the incumbent and the LP point agree, at the
+//           incumbent's value
+//   LP      columns at an integral LP value, at that value (needs no
+//           incumbent)
+//
+// Worker 0 takes the whole RINS set and worker 1 the whole LP set (once);
+// the others fix a random share of one of the two, so their
+// neighbourhoods are larger and differ. Without an incumbent every worker
+// takes the LP set. Neighbourhoods fixing less than min_fixed of the
+// integer columns are skipped.
+//
+// The fixed values go into a copy of the bound arrays only; presolve.hpp
+// then removes the fixed columns, propagates and drops rows that became
+// redundant, and the reduced model goes into Cbc from memory (mip_osi.hpp)
+// with node and time limits and the incumbent as cutoff. Sub-MIP points
+// are postsolved, checked on the full model and offered to the shared
+// incumbent as "rins" / "lpfix".
+//
+// One thread per worker; rounds repeat while a round improves the
+// incumbent, up to `rounds`, and time is left.
+//
+//   LnsConfig cfg; cfg.workers=4;
+//   std::vector<LnsStats> st=run_lns(P, xlp, cfg, inc, deadline);
+//
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "CbcHeuristic.hpp"
+#include "CbcModel.hpp"
+#include "CglClique.hpp"
+#include "CglGomory.hpp"
+#include "CglKnapsackCover.hpp"
+#include "CglMixedIntegerRounding2.hpp"
+#include "CglProbing.hpp"
+#include "OsiClpSolverInterface.hpp"
+
+#include "feas_check.hpp"
+#include "incumbent.hpp"
+#include "mip_osi.hpp"
+#include "mip_problem.hpp"
+#include "presolve.hpp"
+#include "prof.hpp"
+
+struct LnsConfig {
+    int workers=4;                  // neighbourhoods per round, one thread each
+    int rounds=8;                   // at most; stops after a round without improvement
+    int nodes=2000;                 // Cbc node limit per sub-MIP
+    double time=10;                 // seconds per sub-MIP
+    double min_fixed=0.3;           // share of integer columns a neighbourhood must fix
+    double tol=1e-6;                // agreement / integrality tolerance
+    uint64_t seed=1;
+};
+
+struct LnsStats {
+    int solved=0;                   // sub-MIPs handed to Cbc
+    int improved=0;                 // ... whose point improved the incumbent
+    int skipped=0;                  // too few columns fixed
+    int infeasible=0;               // reduced model infeasible in presolve
+    double rows=0, cols=0;          // summed sub-MIP size as a share of the model
+};
+
+namespace lns_detail {
+
+enum Kind { RINS, LP };
+
+// Sets lb = ub on the fixed columns; returns their number. keep < 1 fixes
+// each candidate column with that probability.
+inline int fix_columns(const MipView& P, const double* xlp, const double* xinc, Kind kind,
+                       double keep, double tol, std::mt19937_64& rng,
+                       std::vector<double>& lb, std::vector<double>& ub){
+    std::bernoulli_distribution coin(keep);
+    int fixed=0;
+    for(int j=0;j<P.n;j++){
+        if(!P.is_int[j] || P.lb[j]==P.ub[j]) continue;
+        double v=std::round(xlp[j]);
+        bool cand= kind==RINS ? std::fabs(xinc[j]-xlp[j])<=tol : std::fabs(xlp[j]-v)<=tol;
+        if(kind==RINS) v=std::round(xinc[j]);
+        if(!cand || v<P.lb[j] || v>P.ub[j]) continue;
+        if(keep<1 && !coin(rng)) continue;
+        lb[j]=ub[j]=v;
+        fixed++;
+    }
+    return fixed;
+}
+
+// Cbc on V (offset left out) with a few standard cut
+// generators and simple rounding; false when it finds no point.
+inline bool solve_sub_mip(const MipView& V, int nodes, double seconds, double cutoff,
+                          std::vector<double>& xs){
+    MipView W=V;
+    W.obj_offset=0;
+    OsiClpSolverInterface s;
+    load_osi(s,W);
+    s.messageHandler()->setLogLevel(0);
+    CbcModel cbc(s);
+    cbc.setLogLevel(0);
+    cbc.messageHandler()->setLogLevel(0);
+    CglProbing probing;
+    probing.setUsingObjective(true);
+    probing.setMaxPass(1); probing.setMaxProbe(10); probing.setMaxLook(10);
+    CglGomory gomory; gomory.setLimit(300);
+    CglKnapsackCover knapsack;
+    CglClique clique;
+    CglMixedIntegerRounding2 mir;
+    cbc.addCutGenerator(&probing,-1,"Probing");
+    cbc.addCutGenerator(&gomory,-1,"Gomory");
+    cbc.addCutGenerator(&knapsack,-1,"Knapsack");
+    cbc.addCutGenerator(&clique,-1,"Clique");
+    cbc.addCutGenerator(&mir,-1,"MIR2");
+    CbcRounding rounding(cbc);
+    cbc.addHeuristic(&rounding);
+    cbc.setMaximumNodes(nodes);
+    cbc.setMaximumSeconds(seconds);
+    if(cutoff<MIP_INF) cbc.setCutoff(cutoff);
+    cbc.branchAndBound();
+    const double* b=cbc.bestSolution();
+    if(!b) return false;
+    xs.assign(b,b+V.n);
+    for(int j=0;j<V.n;j++) if(V.is_int[j]) xs[j]=std::round(xs[j]);
+    return true;
+}
+
+} // namespace lns_detail
+
+inline std::vector<LnsStats> run_lns(const MipView& P, const std::vector<double>& xlp, const LnsConfig& cfg,
+                                     SharedIncumbent& inc, std::chrono::steady_clock::time_point deadline){
+    using clock=std::chrono::steady_clock;
+    int N=std::max(1,cfg.workers);
+    std::vector<LnsStats> st(N);
+    int n_int=0;
+    for(int j=0;j<P.n;j++) n_int+=P.is_int[j]!=0;
+    if(n_int==0) return st;
+
+    for(int round=0;round<cfg.rounds && clock::now()<deadline;round++){
+        // the incumbent of this round (the workers only add to it)
+        bool has=inc.has();
+        std::vector<double> xinc;
+        if(has) xinc=inc.x();
+        std::vector<char> better(N,0);
+
+        auto work=[&](int k){
+            PROF_SCOPE("lns.worker");
+            LnsStats& s=st[k];
+            std::mt19937_64 rng(cfg.seed+(uint64_t)round*N+k);
+            lns_detail::Kind kind= has && k%2==0 ? lns_detail::RINS : lns_detail::LP;
+            bool whole= has ? k==0 || (k==1 && round==0) : k==0 && round==0;
+            double keep= whole ? 1.0 : std::uniform_real_distribution<double>(0.6,0.95)(rng);
+            std::vector<double> lb(P.lb,P.lb+P.n), ub(P.ub,P.ub+P.n);
+            int fixed=lns_detail::fix_columns(P,xlp.data(),has?xinc.data():nullptr,kind,keep,cfg.tol,rng,lb,ub);
+            if(fixed<cfg.min_fixed*n_int){ s.skipped++; return; }
+
+            MipView V=P;
+            V.lb=lb.data(); V.ub=ub.data();
+            PresolveOptions po; po.threads=1;
+            Presolved R;
+            if(!presolve(V,R,po)){ s.infeasible++; return; }
+            MipView S=R.model.view();
+            s.rows+=P.m ? (double)S.m/P.m : 0;
+            s.cols+=(double)S.n/P.n;
+
+            // obj.x of the full model = sub objective + shift
+            double shift=R.model.obj_offset-P.obj_offset;
+            double cutoff= inc.has() ? inc.cutoff()-shift : MIP_INF;
+            double left=std::chrono::duration<double>(deadline-clock::now()).count();
+            if(left<=0) return;
+            std::vector<double> xs;
+            s.solved++;
+            if(S.n>0 && !lns_detail::solve_sub_mip(S,cfg.nodes,std::min(cfg.time,left),cutoff,xs)) return;
+            std::vector<double> x=R.postsolve(xs);
+            if(!is_feasible(P,x.data())) return;
+            double o=0;
+            for(int j=0;j<P.n;j++) o+=P.obj[j]*x[j];
+            if(inc.offer(x,o,kind==lns_detail::RINS?"rins":"lpfix")){ s.improved++; better[k]=1; }
+        };
+        std::vector<std::thread> th;
+        for(int k=1;k<N;k++) th.emplace_back(work,k);
+        work(0);
+        for(auto& t:th) t.join();
+        if(std::find(better.begin(),better.end(),1)==better.end()) break;
+    }
+    return st;
+}
@@ -0,0 +1,89 @@
+// ls_state.hpp  (header-only)
+//
+// Incremental local-search state: x, row activities, per-row violation,
+// total violation and objective. move(j,d) touches only CSC column j, so
+// applying a k-variable move costs O(nnz of those columns) instead of
+// O(nnz). Rows and columns changed since the last clear_dirty() are
+// recorded so callers (e.g. the CUDA path in fp2opt) push only those.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "mip_core.hpp"
+#include "mip_problem.hpp"
+#include "spmv.hpp"
+
+struct LsState {
+    const MipView* P=nullptr;
+    double tol=1e-8;
+
+    std::vector<double> x, act, viol;
+    double objv=0;              // obj . x (without offset)
+    double total_viol=0;
+    int n_viol=0;               // rows with viol > tol
+
+    std::vector<int> dirty_rows, dirty_cols;
+    std::vector<unsigned char> row_mark, col_mark;
+
+    void init(const MipView& p, const double* x0, double feas_tol=1e-8){
+        P=&p; tol=feas_tol;
+        x.assign(x0, x0+p.n);
+        act.assign(p.m,0);
+        viol.assign(p.m,0);
+        row_mark.assign(p.m,0);
+        col_mark.assign(p.n,0);
+        dirty_rows.clear(); dirty_cols.clear();
+        refresh();
+    }
+
+    double row_viol(int r, double a) const { return mip_core::row_violation(a,P->rlo[r],P->rhi[r]); }
+
+    // slack to the upper / lower side of row r
+    double slack_hi(int r) const { return P->rhi[r]-act[r]; }
+    double slack_lo(int r) const { return act[r]-P->rlo[r]; }
+
+    bool feasible() const { return n_viol==0; }
+
+    // O(nnz) recompute; also clears accumulated rounding drift
+    void refresh(){
+        const MipView& p=*P;
+        objv=0;
+        for(int j=0;j<p.n;j++) objv+=p.obj[j]*x[j];
+        total_viol=0; n_viol=0;
+        spmv::csr_rows(p,x.data(),0,p.m,act.data());
+        for(int r=0;r<p.m;r++){
+            viol[r]=row_viol(r,act[r]);
+            total_viol+=viol[r];
+            if(viol[r]>tol) n_viol++;
+        }
+    }
+
+    // x[j] += d
+    void move(int j, double d){
+        if(d==0) return;
+        const MipView& p=*P;
+        x[j]+=d;
+        objv+=p.obj[j]*d;
+        if(!col_mark[j]){ col_mark[j]=1; dirty_cols.push_back(j); }
+        for(int k=p.cp[j];k<p.cp[j+1];k++){
+            int r=p.ri[k];
+            act[r]+=p.cv[k]*d;
+            double v=row_viol(r,act[r]);
+            n_viol+=(v>tol)-(viol[r]>tol);
+            total_viol+=v-viol[r];
+            viol[r]=v;
+            if(!row_mark[r]){ row_mark[r]=1; dirty_rows.push_back(r); }
+        }
+    }
+
+    void set(int j, double v){ move(j, v-x[j]); }
+
+    void clear_dirty(){
+        for(int r:dirty_rows) row_mark[r]=0;
+        for(int j:dirty_cols) col_mark[j]=0;
+        dirty_rows.clear(); dirty_cols.clear();
+    }
+};
@@ -0,0 +1,121 @@
+/*
+ * mip_cache.h  (header-only, C and C++)
+ *
+ * Binary instance cache (.mipc). The file is one header followed by the
+ * model arrays, each starting on a 64-byte boundary, so a read-only
+ * MAP_SHARED mapping can be used in place: opening an instance does no
+ * parsing and no allocation, and parallel jobs on the same instance share
+ * the page cache.
+ *
+ * Sections (native endianness, int32 indices, double values):
+ *   rp[m+1] ci[nnz] av[nnz]   CSR
+ *   cp[n+1] ri[nnz] cv[nnz]   CSC
+ *   obj[n] lb[n] ub[n] rlo[m] rhi[m]
+ *   sense[m] ('L','G','E','R')  is_int[n]
+ *   row_off[m+1] (int64) row_names, col_off[n+1] (int64) col_names
+ *
+ * Written by mip_cache.hpp (write_mip_cache), e.g. from unzip_all.
+ * Infinite bounds are stored as +-1e30, like the in-memory model, and obj
+ * is in min form (negated for MAX models, obj_sense = -1).
+ */
+
+#ifndef MIP_CACHE_H
+#define MIP_CACHE_H
+
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MIPC_MAGIC   "MIPCACHE"
+#define MIPC_VERSION 2u
+#define MIPC_ALIGN   64
+
+enum {
+    MIPC_RP, MIPC_CI, MIPC_AV,
+    MIPC_CP, MIPC_RI, MIPC_CV,
+    MIPC_OBJ, MIPC_LB, MIPC_UB, MIPC_RLO, MIPC_RHI,
+    MIPC_SENSE, MIPC_ISINT,
+    MIPC_ROW_OFF, MIPC_ROW_NAMES, MIPC_COL_OFF, MIPC_COL_NAMES,
+    MIPC_NSEC
+};
+
+typedef struct {
+    char     magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    int64_t  m, n, nnz;
+    double   obj_offset;
+    int32_t  obj_sense;
+    int32_t  reserved;
+    int64_t  file_size;
+    int64_t  off[MIPC_NSEC];
+    int64_t  len[MIPC_NSEC];
+} MipCacheHeader;
+
+typedef struct {
+    void*   base;
+    size_t  size;
+    const MipCacheHeader* h;
+} MipCacheMap;
+
+/* Pointer to section s of an open cache. */
+static inline const void* mipc_section(const MipCacheMap* c, int s){
+    return (const char*)c->base + c->h->off[s];
+}
+
+/* Maps path read-only. Returns 0 on success, -1 if the file cannot be
+ * opened, -2 if it is not a valid cache of the current version: bad
+ * magic/version/size, or a section that is misplaced or whose length does
+ * not match m, n and nnz. */
+static inline int mipc_open(const char* path, MipCacheMap* c){
+    memset(c, 0, sizeof(*c));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(MipCacheHeader)) { close(fd); return -2; }
+    void* mem = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) return -1;
+
+    const MipCacheHeader* h = (const MipCacheHeader*)mem;
+    int ok = memcmp(h->magic, MIPC_MAGIC, 8) == 0
+          && h->version == MIPC_VERSION
+          && h->header_size == sizeof(MipCacheHeader)
+          && h->file_size == (int64_t)st.st_size;
+    ok = ok && h->m >= 0 && h->n >= 0 && h->nnz >= 0
+            && h->m < INT32_MAX && h->n < INT32_MAX && h->nnz <= INT32_MAX;
+    if (ok) {
+        int64_t m = h->m, n = h->n, nz = h->nnz;
+        const int64_t want[MIPC_NSEC] = {
+            (m+1)*4, nz*4, nz*8,
+            (n+1)*4, nz*4, nz*8,
+            n*8, n*8, n*8, m*8, m*8,
+            m, n,
+            (m+1)*8, -1, (n+1)*8, -1
+        };
+        for (int s = 0; ok && s < MIPC_NSEC; s++)
+            ok = h->len[s] >= 0 && (want[s] < 0 || h->len[s] == want[s])
+              && h->off[s] >= (int64_t)sizeof(MipCacheHeader)
+              && h->off[s] % MIPC_ALIGN == 0
+              && h->off[s] <= h->file_size - h->len[s];
+    }
+    /* name pools must end where their offset tables say */
+    ok = ok && ((const int64_t*)((const char*)mem + h->off[MIPC_ROW_OFF]))[h->m] == h->len[MIPC_ROW_NAMES]
+            && ((const int64_t*)((const char*)mem + h->off[MIPC_COL_OFF]))[h->n] == h->len[MIPC_COL_NAMES];
+    if (!ok) { munmap(mem, (size_t)st.st_size); return -2; }
+
+    c->base = mem;
+    c->size = (size_t)st.st_size;
+    c->h = h;
+    return 0;
+}
+
+static inline void mipc_close(MipCacheMap* c){
+    if (c->base) munmap(c->base, c->size);
+    memset(c, 0, sizeof(*c));
+}
+
+#endif /* MIP_CACHE_H */
@@ -0,0 +1,150 @@
+// mip_cache.hpp  (header-only, link with -lz)
+//
+// C++ side of the binary instance cache (layout in mip_cache.h).
+//
+//   write_mip_cache("instance_01.mipc", P);        // once, in unzip_all
+//
+//   MipInstance I; std::string err;
+//   if(!I.open("test_set/instances/instance_01.mps", &err)) ...
+//   const MipView& V = I.view;
+//
+// MipInstance::open maps X.mipc if it is given directly or sits next to
+// X.mps / X.mps.gz (and is not older than it), and falls back to parsing
+// the MPS otherwise.
+//
+
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "mip_cache.h"
+#include "mip_problem.hpp"
+#include "mps_reader.hpp"
+
+// X.mps / X.mps.gz / X.mipc -> X.mipc
+inline std::string mip_cache_path(std::string path){
+    if(mps_detail::ends_with(path,".gz")) path.resize(path.size()-3);
+    if(mps_detail::ends_with(path,".mps")) path.resize(path.size()-4);
+    else if(mps_detail::ends_with(path,".mipc")) path.resize(path.size()-5);
+    return path+".mipc";
+}
+
+// Writes P to path via a temporary file and rename, so readers never
+// see a half-written cache.
+inline bool write_mip_cache(const std::string& path, const MipProblem& P){
+    MipCacheHeader h;
+    memset(&h,0,sizeof(h));
+    memcpy(h.magic,MIPC_MAGIC,8);
+    h.version=MIPC_VERSION;
+    h.header_size=sizeof(MipCacheHeader);
+    h.m=P.m; h.n=P.n; h.nnz=P.nnz();
+    h.obj_offset=P.obj_offset;
+    h.obj_sense=P.obj_sense;
+
+    const void* src[MIPC_NSEC];
+    auto sec=[&](int s, const void* p, size_t bytes){ src[s]=p; h.len[s]=(int64_t)bytes; };
+    size_t m=P.m, n=P.n, nz=P.nnz();
+    sec(MIPC_RP, P.rp.data(), (m+1)*sizeof(int));
+    sec(MIPC_CI, P.ci.data(), nz*sizeof(int));
+    sec(MIPC_AV, P.av.data(), nz*sizeof(double));
+    sec(MIPC_CP, P.cp.data(), (n+1)*sizeof(int));
+    sec(MIPC_RI, P.ri.data(), nz*sizeof(int));
+    sec(MIPC_CV, P.cv.data(), nz*sizeof(double));
+    sec(MIPC_OBJ, P.obj.data(), n*sizeof(double));
+    sec(MIPC_LB, P.lb.data(), n*sizeof(double));
+    sec(MIPC_UB, P.ub.data(), n*sizeof(double));
+    sec(MIPC_RLO, P.rlo.data(), m*sizeof(double));
+    sec(MIPC_RHI, P.rhi.data(), m*sizeof(double));
+    sec(MIPC_SENSE, P.sense.data(), m);
+    sec(MIPC_ISINT, P.is_int.data(), n);
+    sec(MIPC_ROW_OFF, P.rows.off.data(), (m+1)*sizeof(int64_t));
+    sec(MIPC_ROW_NAMES, P.rows.pool.data(), P.rows.pool.size());
+    sec(MIPC_COL_OFF, P.cols.off.data(), (n+1)*sizeof(int64_t));
+    sec(MIPC_COL_NAMES, P.cols.pool.data(), P.cols.pool.size());
+
+    int64_t pos=sizeof(MipCacheHeader);
+    for(int s=0;s<MIPC_NSEC;s++){
+        pos=(pos+MIPC_ALIGN-1)/MIPC_ALIGN*MIPC_ALIGN;
+        h.off[s]=pos;
+        pos+=h.len[s];
+    }
+    h.file_size=pos;
+
+    std::string tmp=path+".tmp"+std::to_string((long)getpid());
+    FILE* f=fopen(tmp.c_str(),"wb");
+    if(!f) return false;
+    bool ok=fwrite(&h,sizeof(h),1,f)==1;
+    static const char zeros[MIPC_ALIGN]={0};
+    int64_t at=sizeof(h);
+    for(int s=0;s<MIPC_NSEC && ok;s++){
+        if(h.off[s]>at) ok=fwrite(zeros,1,(size_t)(h.off[s]-at),f)==(size_t)(h.off[s]-at);
+        if(ok && h.len[s]) ok=fwrite(src[s],1,(size_t)h.len[s],f)==(size_t)h.len[s];
+        at=h.off[s]+h.len[s];
+    }
+    ok=(fclose(f)==0) && ok;
+    if(ok) ok=rename(tmp.c_str(),path.c_str())==0;
+    if(!ok) remove(tmp.c_str());
+    return ok;
+}
+
+// Model opened either from a mapped cache or from a parsed MPS file.
+struct MipInstance {
+    MipCacheMap map{};
+    MipProblem owned;
+    MipView view;
+    bool from_cache=false;
+
+    MipInstance() = default;
+    MipInstance(const MipInstance&) = delete;
+    MipInstance& operator=(const MipInstance&) = delete;
+    ~MipInstance(){ mipc_close(&map); }
+
+    bool open(const std::string& path, std::string* err=nullptr){
+        mipc_close(&map);
+        from_cache=false;
+        std::string cpath=mip_cache_path(path);
+        struct stat sm, sc;
+        bool stale=path!=cpath && stat(path.c_str(),&sm)==0 && stat(cpath.c_str(),&sc)==0
+                   && sm.st_mtime>sc.st_mtime;
+        if(!stale && mipc_open(cpath.c_str(),&map)==0){
+            map_view();
+            from_cache=true;
+            return true;
+        }
+        if(mps_detail::ends_with(path,".mipc")){
+            if(err) *err="cannot map cache "+path;
+            return false;
+        }
+        if(!read_mps(path,owned,err)) return false;
+        view=owned.view();
+        return true;
+    }
+
+    void map_view(){
+        const MipCacheHeader* h=map.h;
+        MipView& v=view;
+        v=MipView();
+        v.m=(int)h->m; v.n=(int)h->n; v.nnz=(int)h->nnz;
+        v.rp=(const int*)mipc_section(&map,MIPC_RP);
+        v.ci=(const int*)mipc_section(&map,MIPC_CI);
+        v.av=(const double*)mipc_section(&map,MIPC_AV);
+        v.cp=(const int*)mipc_section(&map,MIPC_CP);
+        v.ri=(const int*)mipc_section(&map,MIPC_RI);
+        v.cv=(const double*)mipc_section(&map,MIPC_CV);
+        v.obj=(const double*)mipc_section(&map,MIPC_OBJ);
+        v.lb=(const double*)mipc_section(&map,MIPC_LB);
+        v.ub=(const double*)mipc_section(&map,MIPC_UB);
+        v.rlo=(const double*)mipc_section(&map,MIPC_RLO);
+        v.rhi=(const double*)mipc_section(&map,MIPC_RHI);
+        v.sense=(const char*)mipc_section(&map,MIPC_SENSE);
+        v.is_int=(const unsigned char*)mipc_section(&map,MIPC_ISINT);
+        v.row_off=(const int64_t*)mipc_section(&map,MIPC_ROW_OFF);
+        v.row_pool=(const char*)mipc_section(&map,MIPC_ROW_NAMES);
+        v.col_off=(const int64_t*)mipc_section(&map,MIPC_COL_OFF);
+        v.col_pool=(const char*)mipc_section(&map,MIPC_COL_NAMES);
+        v.obj_offset=h->obj_offset;
+        v.obj_sense=h->obj_sense;
+    }
+};
@@ -0,0 +1,67 @@
+/*
+ * mip_cache_cuopt.h  (header-only, C)
+ *
+ * Builds a cuOpt problem straight from a mapped .mipc cache, replacing
+ * cuOptReadProblem's MPS parse. The CSR arrays are handed over in place;
+ * only the bounds are copied, to turn the cache's +-1e30 into
+ * CUOPT_INFINITY. All variables are passed as continuous (LP relaxation),
+ * which is what the PDLP drivers solve.
+ */
+
+#ifndef MIP_CACHE_CUOPT_H
+#define MIP_CACHE_CUOPT_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <cuopt/linear_programming/cuopt_c.h>
+
+#include "mip_cache.h"
+
+_Static_assert(sizeof(cuopt_int_t) == sizeof(int32_t), "cuopt_int_t must be 32-bit to use the cache in place");
+_Static_assert(sizeof(cuopt_float_t) == sizeof(double), "cuopt_float_t must be double to use the cache in place");
+
+static inline int mipc_has_suffix(const char* path){
+    size_t L = strlen(path);
+    return L >= 5 && strcmp(path + L - 5, ".mipc") == 0;
+}
+
+static inline cuopt_float_t mipc_inf(double v){
+    if (v >= 1e30) return CUOPT_INFINITY;
+    if (v <= -1e30) return -CUOPT_INFINITY;
+    return v;
+}
+
+static inline cuopt_int_t mipc_create_cuopt_problem(const char* path, cuOptOptimizationProblem* problem){
+    MipCacheMap c;
+    if (mipc_open(path, &c) != 0) return CUOPT_MPS_FILE_ERROR;
+    cuopt_int_t m = (cuopt_int_t)c.h->m, n = (cuopt_int_t)c.h->n;
+
+    cuopt_float_t* bnd = (cuopt_float_t*)malloc(2 * ((size_t)m + n) * sizeof(cuopt_float_t));
+    char* types = (char*)malloc((size_t)n + 1);
+    if (!bnd || !types) { free(bnd); free(types); mipc_close(&c); return CUOPT_INVALID_ARGUMENT; }
+    cuopt_float_t *rlo = bnd, *rhi = bnd + m, *lb = bnd + 2 * m, *ub = bnd + 2 * m + n;
+    const double* src_rlo = (const double*)mipc_section(&c, MIPC_RLO);
+    const double* src_rhi = (const double*)mipc_section(&c, MIPC_RHI);
+    const double* src_lb  = (const double*)mipc_section(&c, MIPC_LB);
+    const double* src_ub  = (const double*)mipc_section(&c, MIPC_UB);
+    for (cuopt_int_t r = 0; r < m; r++) { rlo[r] = mipc_inf(src_rlo[r]); rhi[r] = mipc_inf(src_rhi[r]); }
+    for (cuopt_int_t j = 0; j < n; j++) { lb[j] = mipc_inf(src_lb[j]); ub[j] = mipc_inf(src_ub[j]); }
+    memset(types, CUOPT_CONTINUOUS, (size_t)n);
+
+    cuopt_int_t status = cuOptCreateRangedProblem(
+        m, n,
+        CUOPT_MINIMIZE,                                 /* obj is in min form */
+        c.h->obj_offset,
+        (const cuopt_float_t*)mipc_section(&c, MIPC_OBJ),
+        (const cuopt_int_t*)mipc_section(&c, MIPC_RP),
+        (const cuopt_int_t*)mipc_section(&c, MIPC_CI),
+        (const cuopt_float_t*)mipc_section(&c, MIPC_AV),
+        rlo, rhi, lb, ub, types, problem);
+
+    free(bnd);
+    free(types);
+    mipc_close(&c);
+    return status;
+}
+
+#endif /* MIP_CACHE_CUOPT_H */
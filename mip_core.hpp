@@ -0,0 +1,505 @@
+// mip_core.hpp  (header-only; the MIP_HD functions also compile for CUDA,
+//                the CUDA back end needs nvcc, the CPU one -lpthread and
+//                -fopenmp-simd to vectorize the row loops)
+//
+// Heuristic core shared by the CPU and CUDA code, templated on
+//   V  value type of the matrix, costs and bounds (float or double)
+//   I  index type (int, or int64_t for very large models)
+//   A  accumulator type of activities, deltas and violation sums
+// so float storage with double accumulation halves the bytes moved by
+// activity updates. fp2opt and the CPU engines run on the double model;
+// the 2-opt demos (tut1.cu, src/main.cpp) are float throughout.
+//
+//   CoreModel<V,I>          CSR + CSC views, cost, bounds, row bounds
+//   CoreStorage<V,I>        owning host copy of a MipView in V / I
+//   MoveResult<A>           best move, with a lock word for device updates
+//   step_in_bounds, move_delta, row_activity, row_violation,
+//   column_find, pair_move_feasible, best_move_of_pair   (host and device)
+//   block_offer_move        block reduction + locked update (device)
+//
+// and three operations whose back end is picked with if constexpr:
+//   activities<B>(M, x, act, mag)           row activities A x
+//   check_feasibility<B>(M, act, tol, mag)  total / max violation, count
+//   best_pair_move<B>(M, x, act, pi, pj, np, tol, best)
+// B = Backend::CPU takes host pointers and splits rows or pairs over
+// threads; Backend::CUDA takes device pointers (model included) and
+// launches kernels.
+//
+// Float storage: CoreStorage<float> records per row how far the stored
+// coefficients (relative) and row bounds (absolute) are from the double
+// model, so an activity of x can be off by coef_err_r * mag_r + bound
+// error, mag_r = sum |a_rj x_j| (activities fills it when asked), on top
+// of the double accumulation. The check widens tol by that much: rows
+// counted violated are violated beyond tol in the double model too, and
+// rows within the error of tol are counted as uncertain; there the double
+// check (feas_check.hpp) decides. Integral data is stored exactly and has
+// no error term; neither has V = double, where the row test is the one
+// of feas_check.hpp.
+//
+// two_opt.hpp (and so the CPU engines), fp2opt.cu's GPU 2-opt kernel and
+// ls_state.hpp / feas_jump.hpp use the primitives, bench.cpp the CPU back
+// end on float and double storage, and the demos both back ends.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "mip_problem.hpp"
+
+#ifdef __CUDACC__
+#define MIP_HD __host__ __device__
+#else
+#define MIP_HD
+#endif
+
+namespace mip_core {
+
+// Compressed rows (CSR) or columns (CSC): entries of line k are
+// idx/val[ptr[k] .. ptr[k+1]), indices ascending.
+template<class V, class I=int>
+struct CompressedView {
+    I lines=0;
+    const I* ptr=nullptr;
+    const I* idx=nullptr;
+    const V* val=nullptr;
+};
+
+template<class V, class I=int> using CsrView=CompressedView<V,I>;
+template<class V, class I=int> using CscView=CompressedView<V,I>;
+
+template<class V, class I=int>
+struct CoreModel {
+    I m=0, n=0;
+    CsrView<V,I> csr;
+    CscView<V,I> csc;
+    const V *obj=nullptr, *lb=nullptr, *ub=nullptr;
+    const V *rlo=nullptr, *rhi=nullptr;
+    // rounding of the stored model against its source, per row: largest
+    // relative coefficient error and absolute error of rlo / rhi (null:
+    // stored exactly)
+    const V *coef_err=nullptr, *rlo_err=nullptr, *rhi_err=nullptr;
+};
+
+// The MipView arrays themselves, no copy.
+inline CoreModel<double,int> core_model(const MipView& P){
+    CoreModel<double,int> M;
+    M.m=P.m; M.n=P.n;
+    M.csr={P.m,P.rp,P.ci,P.av};
+    M.csc={P.n,P.cp,P.ri,P.cv};
+    M.obj=P.obj; M.lb=P.lb; M.ub=P.ub; M.rlo=P.rlo; M.rhi=P.rhi;
+    return M;
+}
+
+// Host copy in V / I. Infinite bounds (MIP_INF = 1e30) fit in a float.
+template<class V, class I=int>
+struct CoreStorage {
+    I m=0, n=0;
+    std::vector<I> rp, ci, cp, ri;
+    std::vector<V> av, cv, obj, lb, ub, rlo, rhi;
+    std::vector<V> coef_err, rlo_err, rhi_err;     // empty when V holds double
+
+    explicit CoreStorage(const MipView& P){
+        m=(I)P.m; n=(I)P.n;
+        rp.assign(P.rp,P.rp+P.m+1); ci.assign(P.ci,P.ci+P.nnz);
+        cp.assign(P.cp,P.cp+P.n+1); ri.assign(P.ri,P.ri+P.nnz);
+        av.assign(P.av,P.av+P.nnz); cv.assign(P.cv,P.cv+P.nnz);
+        obj.assign(P.obj,P.obj+P.n); lb.assign(P.lb,P.lb+P.n); ub.assign(P.ub,P.ub+P.n);
+        rlo.assign(P.rlo,P.rlo+P.m); rhi.assign(P.rhi,P.rhi+P.m);
+        if(sizeof(V)>=sizeof(double)) return;
+        coef_err.assign(P.m,0); rlo_err.assign(P.m,0); rhi_err.assign(P.m,0);
+        auto err=[](double b,V v){ return std::fabs(b)<MIP_INF ? (V)std::fabs(b-(double)v) : (V)0; };
+        for(int r=0;r<P.m;r++){
+            double e=0;
+            for(int q=P.rp[r];q<P.rp[r+1];q++)
+                e=std::max(e,std::fabs(P.av[q]-(double)av[q])/std::fabs(P.av[q]));
+            coef_err[r]=(V)e;
+            rlo_err[r]=err(P.rlo[r],rlo[r]);
+            rhi_err[r]=err(P.rhi[r],rhi[r]);
+        }
+    }
+
+    CoreModel<V,I> model() const {
+        CoreModel<V,I> M;
+        M.m=m; M.n=n;
+        M.csr={m,rp.data(),ci.data(),av.data()};
+        M.csc={n,cp.data(),ri.data(),cv.data()};
+        M.obj=obj.data(); M.lb=lb.data(); M.ub=ub.data();
+        M.rlo=rlo.data(); M.rhi=rhi.data();
+        if(!coef_err.empty()){ M.coef_err=coef_err.data(); M.rlo_err=rlo_err.data(); M.rhi_err=rhi_err.data(); }
+        return M;
+    }
+};
+
+// x_i += di, x_j += dj (j = -1, dj = 0 for a single move). mutex is only
+// used by device reductions; the initial delta is the acceptance bound.
+template<class A>
+struct MoveResult {
+    int mutex;
+    A delta;
+    int i, j, di, dj;
+};
+
+// violated: beyond tol (and the storage error); uncertain: within the
+// storage error of tol, always 0 for double storage
+template<class A>
+struct FeasResult {
+    A total=0, max=0;
+    long long violated=0, uncertain=0;
+    bool feasible() const { return violated==0; }
+};
+
+// ---------------- primitives ----------------
+
+template<class V, class I>
+MIP_HD inline bool step_in_bounds(const V* x, const V* lb, const V* ub, I j, int d){
+    V v=x[j]+(V)d;
+    return v>=lb[j]-(V)1e-9 && v<=ub[j]+(V)1e-9;
+}
+
+template<class A, class V, class I>
+MIP_HD inline A move_delta(const V* obj, I i, int di, I j, int dj){
+    A d=(A)obj[i]*di;
+    if(j>=0) d+=(A)obj[j]*dj;
+    return d;
+}
+
+template<class A, class V, class I>
+MIP_HD inline A row_activity(const CsrView<V,I>& R, const V* x, I r){
+    A s=0;
+    I e=R.ptr[r+1];
+#ifndef __CUDA_ARCH__
+#pragma omp simd reduction(+:s)
+#endif
+    for(I k=R.ptr[r];k<e;k++) s+=(A)R.val[k]*(A)x[R.idx[k]];
+    return s;
+}
+
+// a_r . x, and sum |a_rj x_j| in mag
+template<class A, class V, class I>
+MIP_HD inline A row_activity(const CsrView<V,I>& R, const V* x, I r, A& mag){
+    A s=0, g=0;
+    I e=R.ptr[r+1];
+#ifndef __CUDA_ARCH__
+#pragma omp simd reduction(+:s,g)
+#endif
+    for(I k=R.ptr[r];k<e;k++){
+        A t=(A)R.val[k]*(A)x[R.idx[k]];
+        s+=t; g+= t<0 ? -t : t;
+    }
+    mag=g;
+    return s;
+}
+
+template<class A, class V>
+MIP_HD inline A row_violation(A a, V lo, V hi){
+    A v=a-(A)hi, w=(A)lo-a;
+    return v>w ? (v>0?v:0) : (w>0?w:0);
+}
+
+// Position of row r in the sorted CSC row list of column j, or -1: the
+// coefficient lookup a_rj by binary search, O(log nnz_j) and no memory
+// beyond the CSC (instead of an m x n dense copy of A).
+template<class I>
+MIP_HD inline I column_find(const I* cp, const I* ri, I j, I r){
+    I lo=cp[j], hi=cp[j+1];
+    while(lo<hi){
+        I mid=lo+(hi-lo)/2;
+        if(ri[mid]<r) lo=mid+1; else hi=mid;
+    }
+    return lo<cp[j+1] && ri[lo]==r ? lo : (I)-1;
+}
+
+// Rows touched by (i,di),(j,dj) stay within [rlo-tol, rhi+tol]: a merge
+// walk over the sorted CSC row lists of i and j, so rows shared by both
+// columns get the combined change without any coefficient lookup.
+template<class A, class V, class I>
+MIP_HD inline bool pair_move_feasible(const I* cp, const I* ri, const V* cv,
+                                      const A* act, const V* rlo, const V* rhi,
+                                      I i, int di, I j, int dj, A tol){
+    I a=di?cp[i]:0, ae=di?cp[i+1]:0;
+    I b=(j>=0 && dj)?cp[j]:0, be=(j>=0 && dj)?cp[j+1]:0;
+    while(a<ae || b<be){
+        I ra=a<ae?ri[a]:(I)INT_MAX, rb=b<be?ri[b]:(I)INT_MAX;
+        I r; A ch;
+        if(ra<rb){ r=ra; ch=(A)cv[a]*di; a++; }
+        else if(rb<ra){ r=rb; ch=(A)cv[b]*dj; b++; }
+        else { r=ra; ch=(A)cv[a]*di+(A)cv[b]*dj; a++; b++; }
+        A s=act[r]+ch;
+        if(s>(A)rhi[r]+tol || s<(A)rlo[r]-tol) return false;
+    }
+    return true;
+}
+
+template<class A, class V, class I>
+MIP_HD inline bool pair_move_feasible(const CoreModel<V,I>& M, const A* act,
+                                      I i, int di, I j, int dj, A tol){
+    return pair_move_feasible(M.csc.ptr,M.csc.idx,M.csc.val,act,M.rlo,M.rhi,i,di,j,dj,tol);
+}
+
+// Best of the four +-1 moves of pair (i,j) below bound; false if none.
+template<class A, class V, class I>
+MIP_HD inline bool best_move_of_pair(const CoreModel<V,I>& M, const V* x, const A* act,
+                                     I i, I j, A tol, A bound, MoveResult<A>& out){
+    bool found=false;
+    for(int di=-1;di<=1;di+=2){
+        if(!step_in_bounds(x,M.lb,M.ub,i,di)) continue;
+        for(int dj=-1;dj<=1;dj+=2){
+            A d=move_delta<A>(M.obj,i,di,j,dj);
+            if(d>=bound) continue;
+            if(!step_in_bounds(x,M.lb,M.ub,j,dj)) continue;
+            if(!pair_move_feasible(M,act,i,di,j,dj,tol)) continue;
+            bound=d; found=true;
+            out.delta=d; out.i=(int)i; out.j=(int)j; out.di=di; out.dj=dj;
+        }
+    }
+    return found;
+}
+
+// Row r against [lo-tol, hi+tol], each side widened by its storage error
+// (coef_err * mag + bound error): 1 violated, 2 uncertain, 0 satisfied.
+// Same comparisons as feas_check.hpp.
+template<class A, class V, class I>
+MIP_HD inline int row_status(const CoreModel<V,I>& M, I r, A a, A tol, A mag){
+    A c= M.coef_err ? (A)M.coef_err[r]*mag : (A)0;
+    A el= c+(M.rlo_err ? (A)M.rlo_err[r] : (A)0);
+    A eh= c+(M.rhi_err ? (A)M.rhi_err[r] : (A)0);
+    A lo=(A)M.rlo[r], hi=(A)M.rhi[r];
+    if(a>hi+tol+eh || a<lo-tol-el) return 1;
+    if(a>hi+tol-eh || a<lo-tol+el) return 2;
+    return 0;
+}
+
+// ---------------- back ends ----------------
+
+enum class Backend { CPU, CUDA };
+
+template<class T> struct dependent_false : std::false_type {};
+
+#ifdef __CUDACC__
+
+// Block-wide best of the threads' moves mv (i < 0: none) in s, one slot
+// per thread and blockDim.x a power of two, then a single locked update
+// of best by thread 0. Every thread of the block must call it.
+template<class A>
+__device__ inline void block_offer_move(MoveResult<A>* s, const MoveResult<A>& mv, MoveResult<A>* best){
+    int t=threadIdx.x;
+    s[t]=mv;
+    __syncthreads();
+    for(int h=blockDim.x/2;h>0;h>>=1){
+        if(t<h && s[t+h].i>=0 && (s[t].i<0 || s[t+h].delta<s[t].delta)) s[t]=s[t+h];
+        __syncthreads();
+    }
+    if(t!=0 || s[0].i<0) return;
+    while(atomicExch(&best->mutex,1)!=0);
+    if(s[0].delta<best->delta){
+        best->delta=s[0].delta;
+        best->i=s[0].i; best->j=s[0].j;
+        best->di=s[0].di; best->dj=s[0].dj;
+    }
+    __threadfence();
+    atomicExch(&best->mutex,0);
+}
+
+#endif
+
+namespace detail {
+
+// [0, n) in contiguous blocks, one per thread; serial below `grain`
+template<class I, class F>
+inline void cpu_blocks(I n, int threads, I grain, F&& f){
+    if(threads<=0) threads=(int)std::thread::hardware_concurrency();
+    if(threads<=1 || n<grain){ f((I)0,n); return; }
+    std::vector<std::thread> th;
+    for(int t=1;t<threads;t++)
+        th.emplace_back([&,t]{ f((I)((int64_t)n*t/threads),(I)((int64_t)n*(t+1)/threads)); });
+    f((I)0,(I)((int64_t)n/threads));
+    for(auto& t:th) t.join();
+}
+
+#ifdef __CUDACC__
+
+#define MIP_CORE_BS 256
+
+template<class A, class V, class I>
+__global__ void activities_kernel(CoreModel<V,I> M, const V* x, A* act, A* mag){
+    I r=(I)blockIdx.x*blockDim.x+threadIdx.x;
+    if(r>=M.m) return;
+    if(mag) act[r]=row_activity(M.csr,x,r,mag[r]);
+    else act[r]=row_activity<A>(M.csr,x,r);
+}
+
+// non-negative IEEE values order like their bit patterns
+__device__ inline void atomic_max_nonneg(double* p, double v){
+    atomicMax((unsigned long long*)p,(unsigned long long)__double_as_longlong(v));
+}
+__device__ inline void atomic_max_nonneg(float* p, float v){
+    atomicMax((unsigned int*)p,(unsigned int)__float_as_int(v));
+}
+
+template<class A, class V, class I>
+__global__ void feasibility_kernel(CoreModel<V,I> M, const A* act, const A* mag, A tol, FeasResult<A>* out){
+    __shared__ A s_tot[MIP_CORE_BS], s_max[MIP_CORE_BS];
+    __shared__ int s_cnt[MIP_CORE_BS], s_unc[MIP_CORE_BS];
+    I r=(I)blockIdx.x*blockDim.x+threadIdx.x;
+    A v=0; int st=0;
+    if(r<M.m){
+        v=row_violation(act[r],M.rlo[r],M.rhi[r]);
+        st=row_status(M,r,act[r],tol,mag?mag[r]:(act[r]<0?-act[r]:act[r]));
+    }
+    int t=threadIdx.x;
+    s_tot[t]=v; s_max[t]=v; s_cnt[t]= st==1; s_unc[t]= st==2;
+    __syncthreads();
+    for(int h=blockDim.x/2;h>0;h>>=1){
+        if(t<h){
+            s_tot[t]+=s_tot[t+h];
+            s_max[t]=s_max[t+h]>s_max[t]?s_max[t+h]:s_max[t];
+            s_cnt[t]+=s_cnt[t+h];
+            s_unc[t]+=s_unc[t+h];
+        }
+        __syncthreads();
+    }
+    if(t!=0) return;
+    atomicAdd(&out->total,s_tot[0]);
+    atomic_max_nonneg(&out->max,s_max[0]);
+    atomicAdd((unsigned long long*)&out->violated,(unsigned long long)s_cnt[0]);
+    atomicAdd((unsigned long long*)&out->uncertain,(unsigned long long)s_unc[0]);
+}
+
+// one thread per pair, then block_offer_move
+template<class A, class V, class I>
+__global__ void best_pair_kernel(CoreModel<V,I> M, const V* x, const A* act,
+                                 const I* pi, const I* pj, I np, A tol, MoveResult<A>* best){
+    __shared__ MoveResult<A> s[MIP_CORE_BS];
+    I p=(I)blockIdx.x*blockDim.x+threadIdx.x;
+    MoveResult<A> mv={0,best->delta,-1,-1,0,0};
+    if(p<np) best_move_of_pair(M,x,act,pi[p],pj[p],tol,mv.delta,mv);
+    block_offer_move(s,mv,best);
+}
+
+#endif
+
+} // namespace detail
+
+// act[r] = a_r . x for every row, and mag[r] = sum |a_rj x_j| when mag is
+// given (for check_feasibility on float storage). CPU: threads over row
+// blocks (0 = all hardware threads). CUDA: M, x, act, mag are device
+// pointers.
+template<Backend B, class A, class V, class I>
+inline void activities(const CoreModel<V,I>& M, const V* x, A* act, A* mag=nullptr, int threads=0){
+    if constexpr(B==Backend::CPU){
+        detail::cpu_blocks(M.m,threads,(I)4096,[&](I r0,I r1){
+            if(mag) for(I r=r0;r<r1;r++) act[r]=row_activity(M.csr,x,r,mag[r]);
+            else    for(I r=r0;r<r1;r++) act[r]=row_activity<A>(M.csr,x,r);
+        });
+    } else {
+#ifdef __CUDACC__
+        int blocks=(int)((M.m+MIP_CORE_BS-1)/MIP_CORE_BS);
+        if(blocks) detail::activities_kernel<A><<<blocks,MIP_CORE_BS>>>(M,x,act,mag);
+#else
+        static_assert(dependent_false<V>::value,"Backend::CUDA needs nvcc");
+#endif
+    }
+}
+
+// Violation of the activities act against [rlo, rhi]; see the top of the
+// file for mag (without it the error term uses |act_r|, which misses
+// cancellation). CUDA: act and mag are device pointers; the result comes
+// back to the host.
+template<Backend B, class A, class V, class I>
+inline FeasResult<A> check_feasibility(const CoreModel<V,I>& M, const A* act, A tol,
+                                       const A* mag=nullptr, int threads=0){
+    FeasResult<A> R;
+    if constexpr(B==Backend::CPU){
+        if(threads<=0) threads=(int)std::thread::hardware_concurrency();
+        if(threads<1) threads=1;
+        I m=M.m;
+        if(m<65536) threads=1;
+        std::vector<FeasResult<A>> part(threads);
+        auto work=[&](int t){
+            I r0=(I)((int64_t)m*t/threads), r1=(I)((int64_t)m*(t+1)/threads);
+            A tot=0, mx=0; long long c=0, u=0;
+#ifndef __CUDA_ARCH__
+#pragma omp simd reduction(+:tot) reduction(max:mx)
+#endif
+            for(I r=r0;r<r1;r++){
+                A v=row_violation(act[r],M.rlo[r],M.rhi[r]);
+                tot+=v; mx=v>mx?v:mx;
+            }
+            for(I r=r0;r<r1;r++){
+                int st=row_status(M,r,act[r],tol,mag?mag[r]:(act[r]<0?-act[r]:act[r]));
+                c+=st==1; u+=st==2;
+            }
+            part[t].total=tot; part[t].max=mx; part[t].violated=c; part[t].uncertain=u;
+        };
+        if(threads==1) work(0);
+        else {
+            std::vector<std::thread> th;
+            for(int t=1;t<threads;t++) th.emplace_back(work,t);
+            work(0);
+            for(auto& t:th) t.join();
+        }
+        for(const FeasResult<A>& q:part){
+            R.total+=q.total;
+            R.max=std::max(R.max,q.max);
+            R.violated+=q.violated;
+            R.uncertain+=q.uncertain;
+        }
+    } else {
+#ifdef __CUDACC__
+        FeasResult<A>* d=nullptr;
+        cudaMalloc(&d,sizeof(R));
+        cudaMemcpy(d,&R,sizeof(R),cudaMemcpyHostToDevice);
+        int blocks=(int)((M.m+MIP_CORE_BS-1)/MIP_CORE_BS);
+        if(blocks) detail::feasibility_kernel<A><<<blocks,MIP_CORE_BS>>>(M,act,mag,tol,d);
+        cudaMemcpy(&R,d,sizeof(R),cudaMemcpyDeviceToHost);
+        cudaFree(d);
+#else
+        static_assert(dependent_false<V>::value,"Backend::CUDA needs nvcc");
+#endif
+    }
+    return R;
+}
+
+// Best feasible move over the candidate pairs (pi[p], pj[p]) that
+// improves on best.delta; best is updated in place. CUDA: every pointer,
+// best included, is a device pointer.
+template<Backend B, class A, class V, class I>
+inline void best_pair_move(const CoreModel<V,I>& M, const V* x, const A* act,
+                           const I* pi, const I* pj, I np, A tol, MoveResult<A>* best,
+                           int threads=0){
+    if constexpr(B==Backend::CPU){
+        if(threads<=0) threads=(int)std::thread::hardware_concurrency();
+        if(threads<1 || np<4096) threads=1;
+        std::vector<MoveResult<A>> part(threads,*best);
+        auto work=[&](int t){
+            MoveResult<A>& mv=part[t];
+            I p0=(I)((int64_t)np*t/threads), p1=(I)((int64_t)np*(t+1)/threads);
+            for(I p=p0;p<p1;p++) best_move_of_pair(M,x,act,pi[p],pj[p],tol,mv.delta,mv);
+        };
+        if(threads==1) work(0);
+        else {
+            std::vector<std::thread> th;
+            for(int t=1;t<threads;t++) th.emplace_back(work,t);
+            work(0);
+            for(auto& t:th) t.join();
+        }
+        for(const MoveResult<A>& mv:part)
+            if(mv.delta<best->delta){ int mu=best->mutex; *best=mv; best->mutex=mu; }
+    } else {
+#ifdef __CUDACC__
+        int blocks=(int)((np+MIP_CORE_BS-1)/MIP_CORE_BS);
+        if(blocks) detail::best_pair_kernel<A><<<blocks,MIP_CORE_BS>>>(M,x,act,pi,pj,np,tol,best);
+#else
+        static_assert(dependent_false<V>::value,"Backend::CUDA needs nvcc");
+#endif
+    }
+}
+
+} // namespace mip_core
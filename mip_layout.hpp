@@ -0,0 +1,210 @@
+// mip_layout.hpp  (header-only)
+//
+// Matrix storage and layout of a MipProblem:
+//
+//   mip_build_matrix(P, nz, row, col, val)   CSR and CSC from triplets in
+//       one counting pass (row and column lengths together), exact sizes,
+//       one scatter into both; lines are sorted only if the input was not
+//       in column order.
+//   rcm_order(P)                  reverse Cuthill-McKee order of rows and
+//       columns (on the bipartite row/column graph), so rows that share
+//       columns sit together and the columns of a row have close indices.
+//   permute_model(P, ord, out)    the model in that order, names included.
+//   ord.to_original(x), ord.to_reordered(x)   points between the spaces.
+//   gather_stats(P)               mean column span of a row and simulated
+//       cache misses per nonzero of the x[ci[k]] gathers in A x.
+//
+// Heuristics keep working on a MipView; only the index space changes, so
+// every solution must go through to_original before it is written.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "mip_problem.hpp"
+
+namespace layout_detail {
+
+// sorts idx/val inside every line whose indices are not ascending
+inline void sort_lines(int lines, const std::vector<int>& ptr, std::vector<int>& idx, std::vector<double>& val){
+    std::vector<std::pair<int,double>> tmp;
+    for(int l=0;l<lines;l++){
+        int s=ptr[l], e=ptr[l+1];
+        bool sorted=true;
+        for(int k=s+1;k<e && sorted;k++) sorted=idx[k-1]<idx[k];
+        if(sorted) continue;
+        tmp.clear();
+        for(int k=s;k<e;k++) tmp.push_back({idx[k],val[k]});
+        std::sort(tmp.begin(),tmp.end());
+        for(int k=s;k<e;k++){ idx[k]=tmp[k-s].first; val[k]=tmp[k-s].second; }
+    }
+}
+
+} // namespace layout_detail
+
+// P.m and P.n must be set. Entries are (row[k], col[k], val[k]); in column
+// order (as MPS files store them) no sort is needed.
+inline void mip_build_matrix(MipProblem& P, int64_t nz, const int* row, const int* col, const double* val){
+    int m=P.m, n=P.n;
+    P.rp.assign(m+1,0);
+    P.cp.assign(n+1,0);
+    for(int64_t k=0;k<nz;k++){ P.rp[row[k]+1]++; P.cp[col[k]+1]++; }
+    for(int r=0;r<m;r++) P.rp[r+1]+=P.rp[r];
+    for(int j=0;j<n;j++) P.cp[j+1]+=P.cp[j];
+    P.ci.resize(nz); P.av.resize(nz);
+    P.ri.resize(nz); P.cv.resize(nz);
+    std::vector<int> rpos(P.rp.begin(),P.rp.end()-1), cpos(P.cp.begin(),P.cp.end()-1);
+    for(int64_t k=0;k<nz;k++){
+        int q=rpos[row[k]]++;
+        P.ci[q]=col[k]; P.av[q]=val[k];
+        q=cpos[col[k]]++;
+        P.ri[q]=row[k]; P.cv[q]=val[k];
+    }
+    layout_detail::sort_lines(m,P.rp,P.ci,P.av);
+    layout_detail::sort_lines(n,P.cp,P.ri,P.cv);
+}
+
+// perm: new index -> original, inv: original -> new
+struct MatrixOrder {
+    std::vector<int> row_perm, row_inv, col_perm, col_inv;
+
+    bool empty() const { return col_perm.empty() && row_perm.empty(); }
+
+    std::vector<double> to_original(const std::vector<double>& x) const {
+        std::vector<double> y(x.size());
+        for(size_t j=0;j<x.size();j++) y[col_perm[j]]=x[j];
+        return y;
+    }
+    std::vector<double> to_reordered(const std::vector<double>& x) const {
+        std::vector<double> y(x.size());
+        for(size_t j=0;j<x.size();j++) y[col_inv[j]]=x[j];
+        return y;
+    }
+};
+
+// Graph nodes: rows 0..m-1, columns m..m+n-1, one edge per nonzero. Each
+// component is numbered by BFS from a pseudo-peripheral node (the far end
+// of a BFS started at a minimum-degree node), neighbours in increasing
+// degree; the numbering is then reversed.
+inline MatrixOrder rcm_order(const MipView& P){
+    int m=P.m, n=P.n, N=m+n;
+    auto deg=[&](int v){ return v<m ? P.rp[v+1]-P.rp[v] : P.cp[v-m+1]-P.cp[v-m]; };
+    auto adj=[&](int v, auto&& f){
+        if(v<m) for(int k=P.rp[v];k<P.rp[v+1];k++) f(m+P.ci[k]);
+        else    for(int k=P.cp[v-m];k<P.cp[v-m+1];k++) f(P.ri[k]);
+    };
+
+    std::vector<int> order; order.reserve(N);
+    std::vector<int> level(N,-1), nb;
+    std::vector<unsigned char> done(N,0);
+    // BFS over the unnumbered part of v's component; returns the last node
+    // of the deepest level with the smallest degree
+    std::vector<int> q;
+    auto bfs_far=[&](int v){
+        q.clear(); q.push_back(v); level[v]=0;
+        for(size_t h=0;h<q.size();h++){
+            int u=q[h];
+            adj(u,[&](int w){ if(!done[w] && level[w]<0){ level[w]=level[u]+1; q.push_back(w); } });
+        }
+        int far=q.back(), L=level[far];
+        for(int u:q) if(level[u]==L && deg(u)<deg(far)) far=u;
+        for(int u:q) level[u]=-1;
+        return std::make_pair(far,L);
+    };
+
+    std::vector<int> by_deg(N);
+    for(int v=0;v<N;v++) by_deg[v]=v;
+    std::stable_sort(by_deg.begin(),by_deg.end(),[&](int a,int b){ return deg(a)<deg(b); });
+
+    for(int s:by_deg){
+        if(done[s]) continue;
+        // pseudo-peripheral start: move to the far end while the depth grows
+        auto f=bfs_far(s);
+        for(int it=0;it<4;it++){
+            auto g=bfs_far(f.first);
+            if(g.second<=f.second) break;
+            f=g;
+        }
+        size_t h=order.size();
+        order.push_back(f.first); done[f.first]=1;
+        for(;h<order.size();h++){
+            nb.clear();
+            adj(order[h],[&](int w){ if(!done[w]){ done[w]=1; nb.push_back(w); } });
+            std::stable_sort(nb.begin(),nb.end(),[&](int a,int b){ return deg(a)<deg(b); });
+            order.insert(order.end(),nb.begin(),nb.end());
+        }
+    }
+    std::reverse(order.begin(),order.end());
+
+    MatrixOrder o;
+    o.row_perm.reserve(m); o.col_perm.reserve(n);
+    for(int v:order){
+        if(v<m) o.row_perm.push_back(v);
+        else    o.col_perm.push_back(v-m);
+    }
+    o.row_inv.resize(m); o.col_inv.resize(n);
+    for(int r=0;r<m;r++) o.row_inv[o.row_perm[r]]=r;
+    for(int j=0;j<n;j++) o.col_inv[o.col_perm[j]]=j;
+    return o;
+}
+
+inline void permute_model(const MipView& P, const MatrixOrder& o, MipProblem& M){
+    M=MipProblem();
+    M.m=P.m; M.n=P.n;
+    M.obj_offset=P.obj_offset; M.obj_sense=P.obj_sense;
+    std::vector<int> row, col;
+    std::vector<double> val;
+    row.reserve(P.nnz); col.reserve(P.nnz); val.reserve(P.nnz);
+    M.obj.resize(P.n); M.lb.resize(P.n); M.ub.resize(P.n); M.is_int.resize(P.n);
+    for(int j=0;j<P.n;j++){
+        int c=o.col_perm[j];
+        for(int k=P.cp[c];k<P.cp[c+1];k++){
+            row.push_back(o.row_inv[P.ri[k]]); col.push_back(j); val.push_back(P.cv[k]);
+        }
+        M.obj[j]=P.obj[c]; M.lb[j]=P.lb[c]; M.ub[j]=P.ub[c]; M.is_int[j]=P.is_int[c];
+        M.cols.intern(P.col_name(c));
+    }
+    M.rlo.resize(P.m); M.rhi.resize(P.m); M.sense.resize(P.m);
+    for(int r=0;r<P.m;r++){
+        int s=o.row_perm[r];
+        M.rlo[r]=P.rlo[s]; M.rhi[r]=P.rhi[s]; M.sense[r]=P.sense[s];
+        M.rows.intern(P.row_name(s));
+    }
+    mip_build_matrix(M,(int64_t)row.size(),row.data(),col.data(),val.data());
+}
+
+struct GatherStats {
+    double mean_span=0;             // mean of max - min column index over rows
+    double misses_per_nnz=0;        // x gathers of A x missing a simulated cache
+};
+
+// x[ci[k]] in CSR order through an LRU, set-associative cache of
+// cache_bytes with 64-byte lines (8 doubles); other arrays are streamed
+// and left out.
+inline GatherStats gather_stats(const MipView& P, int64_t cache_bytes=32<<10, int ways=8){
+    GatherStats g;
+    int64_t sets=std::max<int64_t>(1,cache_bytes/64/ways);
+    std::vector<int64_t> tag(sets*ways,-1), age(sets*ways,0);
+    int64_t clock=0, miss=0;
+    double span=0;
+    for(int r=0;r<P.m;r++){
+        int s=P.rp[r], e=P.rp[r+1];
+        if(e>s) span+=P.ci[e-1]-P.ci[s];
+        for(int k=s;k<e;k++){
+            int64_t line=P.ci[k]>>3;
+            int64_t* t=&tag[(line%sets)*ways];
+            int64_t* a=&age[(line%sets)*ways];
+            int w=0, lru=0;
+            for(;w<ways && t[w]!=line;w++) if(a[w]<a[lru]) lru=w;
+            if(w==ways){ miss++; w=lru; t[w]=line; }
+            a[w]=++clock;
+        }
+    }
+    g.mean_span= P.m ? span/P.m : 0;
+    g.misses_per_nnz= P.nnz ? (double)miss/P.nnz : 0;
+    return g;
+}
@@ -0,0 +1,25 @@
+// mip_osi.hpp  (header-only, needs Osi/Clp)
+//
+// Loads a model into an Osi solver straight from its CSC arrays, so tools
+// that need Clp do not parse the MPS a second time.
+//
+
+#pragma once
+
+#include "OsiSolverInterface.hpp"
+#include "mip_problem.hpp"
+
+inline void load_osi(OsiSolverInterface& s, const MipView& P, bool keep_int=true, bool names=false){
+    s.loadProblem(P.n, P.m, P.cp, P.ri, P.cv, P.lb, P.ub, P.obj, P.rlo, P.rhi);
+    s.setObjSense(1);                               // obj is in min form
+    s.setDblParam(OsiObjOffset, -P.obj_offset);     // Osi subtracts its offset
+    if(keep_int){
+        for(int j=0;j<P.n;j++) if(P.is_int[j]) s.setInteger(j);
+    }
+    if(names){
+        s.setIntParam(OsiNameDiscipline,2);
+        for(int r=0;r<P.m;r++) s.setRowName(r, std::string(P.row_name(r)));
+        for(int j=0;j<P.n;j++) s.setColName(j, std::string(P.col_name(j)));
+        s.setObjName("OBJ");
+    }
+}
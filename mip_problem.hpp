@@ -0,0 +1,172 @@
+// mip_problem.hpp  (header-only)
+//
+// In-memory MIP model shared by the native tools: CSR + CSC matrix,
+// column bounds, row bounds/senses, integrality, objective and names.
+//
+// Conventions (same as Coin/Osi):
+//   rows:    rlo[r] <= sum_k av[k]*x[ci[k]] <= rhi[r]
+//   columns: lb[j] <= x[j] <= ub[j]
+//   |bound| >= MIP_INF means unbounded.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+constexpr double MIP_INF = 1e30;
+
+// -------- NAME TABLE ----------
+// Flat interned names: all characters in one pool, name k is
+// pool[off[k] .. off[k+1]). Lookup goes through an open-addressing
+// hash of indices, so no per-name allocation happens.
+
+struct NameTable {
+    std::vector<char> pool;
+    std::vector<int64_t> off{0};
+    std::vector<int> slots;          // -1 = empty
+
+    int size() const { return (int)off.size()-1; }
+
+    std::string_view get(int k) const {
+        return std::string_view(pool.data()+off[k], (size_t)(off[k+1]-off[k]));
+    }
+
+    static uint64_t hash(std::string_view s){
+        uint64_t h=1469598103934665603ull;              // FNV-1a
+        for(unsigned char c:s){ h^=c; h*=1099511628211ull; }
+        return h;
+    }
+
+    int find(std::string_view s) const {
+        if(slots.empty()) return -1;
+        size_t mask=slots.size()-1, p=hash(s)&mask;
+        while(slots[p]>=0){
+            if(get(slots[p])==s) return slots[p];
+            p=(p+1)&mask;
+        }
+        return -1;
+    }
+
+    // returns the index of s, inserting it if new
+    int intern(std::string_view s){
+        if((size_t)(size()+1)*2 > slots.size()) rehash(slots.empty()?1024:slots.size()*2);
+        size_t mask=slots.size()-1, p=hash(s)&mask;
+        while(slots[p]>=0){
+            if(get(slots[p])==s) return slots[p];
+            p=(p+1)&mask;
+        }
+        int k=size();
+        pool.insert(pool.end(), s.begin(), s.end());
+        off.push_back((int64_t)pool.size());
+        slots[p]=k;
+        return k;
+    }
+
+    void rehash(size_t cap){
+        slots.assign(cap,-1);
+        size_t mask=cap-1;
+        for(int k=0;k<size();k++){
+            size_t p=hash(get(k))&mask;
+            while(slots[p]>=0) p=(p+1)&mask;
+            slots[p]=k;
+        }
+    }
+};
+
+// -------- VIEW ----------
+// Non-owning view of a model. Heuristics take a MipView so they run the
+// same on a parsed MipProblem and on a mmap'ed binary cache (mip_cache.hpp).
+
+struct MipView {
+    int m=0, n=0, nnz=0;
+    const int *rp=nullptr, *ci=nullptr;
+    const double* av=nullptr;
+    const int *cp=nullptr, *ri=nullptr;
+    const double* cv=nullptr;
+    const double *obj=nullptr, *lb=nullptr, *ub=nullptr;
+    const double *rlo=nullptr, *rhi=nullptr;
+    const char* sense=nullptr;
+    const unsigned char* is_int=nullptr;
+    double obj_offset=0;
+    int obj_sense=1;
+    const int64_t *row_off=nullptr, *col_off=nullptr;
+    const char *row_pool=nullptr, *col_pool=nullptr;
+
+    std::string_view row_name(int r) const {
+        return std::string_view(row_pool+row_off[r], (size_t)(row_off[r+1]-row_off[r]));
+    }
+    std::string_view col_name(int j) const {
+        return std::string_view(col_pool+col_off[j], (size_t)(col_off[j+1]-col_off[j]));
+    }
+    double rhs(int r) const {
+        return (sense[r]=='G' || sense[r]=='E') ? rlo[r] : rhi[r];
+    }
+};
+
+// -------- MODEL ----------
+
+struct MipProblem {
+    std::string name;
+    int m=0, n=0;
+
+    // row-major (columns ascending inside each row)
+    std::vector<int> rp, ci;
+    std::vector<double> av;
+    // column-major (rows ascending inside each column)
+    std::vector<int> cp, ri;
+    std::vector<double> cv;
+
+    std::vector<double> obj, lb, ub;
+    std::vector<double> rlo, rhi;
+    std::vector<char> sense;            // 'L','G','E', or 'R' for ranged rows
+    std::vector<unsigned char> is_int;
+
+    double obj_offset=0;                // minimise obj.x + obj_offset
+    int obj_sense=1;                    // -1: read as MAX, obj and offset negated;
+                                        // model objective = obj_sense*(obj.x+obj_offset)
+
+    NameTable rows, cols;
+
+    int nnz() const { return (int)av.size(); }
+
+    // Osi-style right-hand side: the finite side of the row
+    double rhs(int r) const {
+        return (sense[r]=='G' || sense[r]=='E') ? rlo[r] : rhi[r];
+    }
+
+    MipView view() const {
+        MipView v;
+        v.m=m; v.n=n; v.nnz=nnz();
+        v.rp=rp.data(); v.ci=ci.data(); v.av=av.data();
+        v.cp=cp.data(); v.ri=ri.data(); v.cv=cv.data();
+        v.obj=obj.data(); v.lb=lb.data(); v.ub=ub.data();
+        v.rlo=rlo.data(); v.rhi=rhi.data();
+        v.sense=sense.data(); v.is_int=is_int.data();
+        v.obj_offset=obj_offset; v.obj_sense=obj_sense;
+        v.row_off=rows.off.data(); v.row_pool=rows.pool.data();
+        v.col_off=cols.off.data(); v.col_pool=cols.pool.data();
+        return v;
+    }
+};
+
+// Builds the CSR arrays from CSC with one counting pass.
+inline void mip_build_csr(MipProblem& P){
+    int m=P.m, n=P.n, nz=(int)P.cv.size();
+    P.rp.assign(m+1,0);
+    P.ci.resize(nz);
+    P.av.resize(nz);
+    for(int k=0;k<nz;k++) P.rp[P.ri[k]+1]++;
+    for(int r=0;r<m;r++) P.rp[r+1]+=P.rp[r];
+    std::vector<int> pos(P.rp.begin(), P.rp.end()-1);
+    for(int j=0;j<n;j++){
+        for(int k=P.cp[j];k<P.cp[j+1];k++){
+            int q=pos[P.ri[k]]++;
+            P.ci[q]=j;
+            P.av[q]=P.cv[k];
+        }
+    }
+}
@@ -0,0 +1,129 @@
+/*
+ * mip_sol.h  (header-only, C and C++)
+ *
+ * Sparse binary solution file (.msol): one header followed by the nonzero
+ * entries only,
+ *     int32 idx[nnz]   (ascending, 0-based), padded to 8 bytes
+ *     double val[nnz]
+ * so an incumbent of a 150k-column model with few nonzeros is a few KB
+ * and is written with two fwrite calls. The header carries the
+ * objective, a wall-clock timestamp and the producing heuristic.
+ *
+ * msol_write_file() picks the format from the suffix: .msol is binary,
+ * anything else is the cuOpt text format ("Objective = v", "x1 = v", ...)
+ * written through a large stdio buffer. Files are written to a temporary
+ * name and renamed, so readers never see a partial solution.
+ */
+
+#ifndef MIP_SOL_H
+#define MIP_SOL_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MSOL_MAGIC   "MIPSOL\0\0"
+#define MSOL_VERSION 1u
+
+typedef struct {
+    char     magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    int64_t  n;             /* dimension of x */
+    int64_t  nnz;           /* stored entries */
+    double   obj;
+    double   timestamp;     /* seconds since the epoch */
+    char     source[32];    /* producing heuristic, NUL-padded */
+    int64_t  reserved[2];
+} MipSolHeader;
+
+static inline double msol_now(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+}
+
+static inline int64_t msol_idx_bytes(int64_t nnz){
+    return (nnz * (int64_t)sizeof(int32_t) + 7) & ~(int64_t)7;
+}
+
+static inline int msol_has_suffix(const char* path){
+    size_t L = strlen(path);
+    return L >= 5 && strcmp(path + L - 5, ".msol") == 0;
+}
+
+static inline FILE* msol_open_tmp(const char* path, char* tmp, size_t cap){
+    if ((size_t)snprintf(tmp, cap, "%s.tmp", path) >= cap) return NULL;
+    return fopen(tmp, "wb");
+}
+
+static inline int msol_commit(FILE* f, const char* tmp, const char* path){
+    int bad = ferror(f);
+    if (fclose(f) != 0) bad = 1;
+    if (bad || rename(tmp, path) != 0) { remove(tmp); return -1; }
+    return 0;
+}
+
+/* Writes the nnz entries (idx ascending) of an n-vector. 0 on success. */
+static inline int msol_write_sparse(const char* path, int64_t n, int64_t nnz,
+                                    const int32_t* idx, const double* val,
+                                    double obj, double timestamp, const char* source){
+    MipSolHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, MSOL_MAGIC, 8);
+    h.version = MSOL_VERSION;
+    h.header_size = sizeof(MipSolHeader);
+    h.n = n; h.nnz = nnz;
+    h.obj = obj;
+    h.timestamp = timestamp;
+    if (source) strncpy(h.source, source, sizeof(h.source) - 1);
+
+    char tmp[4096];
+    FILE* f = msol_open_tmp(path, tmp, sizeof(tmp));
+    if (!f) return -1;
+    static const char zero[8] = {0};
+    int64_t pad = msol_idx_bytes(nnz) - nnz * (int64_t)sizeof(int32_t);
+    fwrite(&h, sizeof(h), 1, f);
+    if (nnz) {
+        fwrite(idx, sizeof(int32_t), (size_t)nnz, f);
+        fwrite(zero, 1, (size_t)pad, f);
+        fwrite(val, sizeof(double), (size_t)nnz, f);
+    }
+    return msol_commit(f, tmp, path);
+}
+
+/* Dense x -> sparse binary file. */
+static inline int msol_write(const char* path, int64_t n, const double* x,
+                             double obj, const char* source){
+    int64_t nnz = 0, i;
+    for (i = 0; i < n; i++) nnz += x[i] != 0.0;
+    int32_t* idx = (int32_t*)malloc((size_t)(nnz ? nnz : 1) * sizeof(int32_t));
+    double*  val = (double*)malloc((size_t)(nnz ? nnz : 1) * sizeof(double));
+    if (!idx || !val) { free(idx); free(val); return -1; }
+    int64_t k = 0;
+    for (i = 0; i < n; i++) if (x[i] != 0.0) { idx[k] = (int32_t)i; val[k] = x[i]; k++; }
+    int rc = msol_write_sparse(path, n, nnz, idx, val, obj, msol_now(), source);
+    free(idx); free(val);
+    return rc;
+}
+
+/* cuOpt text format: "Objective = v" then "x<i+1> = v" for every column. */
+static inline int msol_write_text(const char* path, int64_t n, const double* x, double obj){
+    char tmp[4096];
+    FILE* f = msol_open_tmp(path, tmp, sizeof(tmp));
+    if (!f) return -1;
+    setvbuf(f, NULL, _IOFBF, 1 << 20);
+    fprintf(f, "Objective = %f\n", obj);
+    for (int64_t i = 0; i < n; i++) fprintf(f, "x%lld = %f\n", (long long)(i + 1), x[i]);
+    return msol_commit(f, tmp, path);
+}
+
+static inline int msol_write_file(const char* path, int64_t n, const double* x,
+                                  double obj, const char* source){
+    return msol_has_suffix(path) ? msol_write(path, n, x, obj, source)
+                                 : msol_write_text(path, n, x, obj);
+}
+
+#endif /* MIP_SOL_H */
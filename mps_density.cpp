@@ -1,10 +1,10 @@
 #include <iostream>
-#include <fstream>
 #include <sstream>
-#include <unordered_set>
-#include <unordered_map>
 #include <string>
 #include <iomanip>
+#include <filesystem>
+
+#include "mip_cache.hpp"
 
 int main() {
     for (int idx = 1; idx <= 50; idx++) {
@@ -13,61 +13,24 @@ int main() {
               << std::setw(2) << std::setfill('0') << idx
               << ".mps";
 
-        std::ifstream fin(fname.str());
-        if (!fin.is_open()) {
+        // prefer the cache / unzipped file, fall back to streaming the .gz
+        std::string path = fname.str();
+        if (!std::filesystem::exists(path) && !std::filesystem::exists(mip_cache_path(path))) path += ".gz";
+        if (!std::filesystem::exists(path) && !std::filesystem::exists(mip_cache_path(path))) {
             std::cerr << "Could not open " << fname.str() << "\n";
             continue;
         }
 
-        std::string line, section;
-        std::string obj_row;
-
-        std::unordered_set<std::string> rows;   // constraints
-        std::unordered_set<std::string> cols;   // variables
-        long long nnz = 0;
-
-        while (std::getline(fin, line)) {
-            if (line.empty() || line[0] == '*') continue;
-
-            std::stringstream ss(line);
-            std::string a, b, c, d, e;
-
-            ss >> a;
-            if (a == "ROWS" || a == "COLUMNS" || a == "RHS" ||
-                a == "BOUNDS" || a == "ENDATA") {
-                section = a;
-                continue;
-            }
-
-            if (section == "ROWS") {
-                // format: type row_name
-                char type = a[0];
-                ss >> b;
-                if (type == 'N') {
-                    obj_row = b;   // objective row
-                } else {
-                    rows.insert(b);
-                }
-            }
-            else if (section == "COLUMNS") {
-                // format:
-                // col row val [row val]
-                std::string col = a;
-                cols.insert(col);
-
-                ss >> b >> c;
-                if (b != obj_row) nnz++;
-
-                if (ss >> d >> e) {
-                    if (d != obj_row) nnz++;
-                }
-            }
+        MipInstance inst;
+        std::string err;
+        if (!inst.open(path, &err)) {
+            std::cerr << "Error reading " << path << ": " << err << "\n";
+            continue;
         }
 
-        fin.close();
-
-        long long m = rows.size();
-        long long n = cols.size();
+        long long m = inst.view.m;
+        long long n = inst.view.n;
+        long long nnz = inst.view.nnz;
 
         double density = (m > 0 && n > 0)
                          ? static_cast<double>(nnz) / (m * n)
@@ -84,5 +47,5 @@ int main() {
     return 0;
 }
 
-// g++ -std=c++17 mps_density.cpp -O2 -o mps_density
+// g++ -std=c++17 mps_density.cpp -O2 -o mps_density -lz
 // ./mps_density
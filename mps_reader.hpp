@@ -0,0 +1,351 @@
+// mps_reader.hpp  (header-only, link with -lz)
+//
+// Native MPS reader. Plain .mps files are mmap'ed and parsed in place,
+// .mps.gz files are streamed through zlib in fixed-size chunks, so no
+// decompressed copy of the file is ever held in memory.
+// Row and column names are interned into flat hash tables and the CSC/CSR
+// matrix, bounds, row ranges, integrality and objective are produced in a
+// single pass over the file.
+//
+// Usage:
+//   MipProblem P; std::string err;
+//   if(!read_mps("test_set/instances/instance_01.mps.gz", P, &err)) ...
+//
+// Supports free and fixed MPS without spaces in names: ROWS, COLUMNS
+// (with INTORG/INTEND markers), RHS, RANGES, BOUNDS (UP LO FX FR MI PL
+// BV LI UI SC) and OBJSENSE. A MAX model is stored in min form: obj and
+// obj_offset are negated and obj_sense = -1 is kept for reporting only.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "mip_layout.hpp"
+#include "mip_problem.hpp"
+
+namespace mps_detail {
+
+enum Section { NONE, NAME, ROWS, COLUMNS, RHS, RANGES, BOUNDS, OBJSENSE, END };
+
+struct Parser {
+    MipProblem& P;
+    std::string err;
+    Section sec=NONE;
+    long line_no=0;
+
+    std::string obj_row;
+    NameTable free_rows;            // N rows after the objective: dropped
+    bool in_int=false;
+    int cur_col=-1;
+    // matrix triplets in file order (column-major for valid MPS)
+    std::vector<int> e_col, e_row;
+    std::vector<double> e_val;
+    std::vector<double> rhs, rng;
+    std::vector<unsigned char> has_rng;
+    std::vector<unsigned char> lb_set;
+
+    explicit Parser(MipProblem& p): P(p) {}
+
+    bool fail(const std::string& msg){
+        if(err.empty()) err="line "+std::to_string(line_no)+": "+msg;
+        return false;
+    }
+
+    static int split(std::string_view s, std::string_view* tok, int max){
+        int k=0; size_t i=0, L=s.size();
+        while(i<L && k<max){
+            while(i<L && (s[i]==' '||s[i]=='\t')) i++;
+            if(i>=L) break;
+            size_t b=i;
+            while(i<L && s[i]!=' ' && s[i]!='\t') i++;
+            tok[k++]=s.substr(b,i-b);
+        }
+        return k;
+    }
+
+    bool num(std::string_view s, double& v){
+        const char* b=s.data(); const char* e=b+s.size();
+        if(b<e && *b=='+') b++;
+        auto r=std::from_chars(b,e,v);
+        if(r.ec!=std::errc() || r.ptr!=e) return fail("bad number '"+std::string(s)+"'");
+        return true;
+    }
+
+    bool header(std::string_view* t, int nt){
+        std::string_view h=t[0];
+        if(h=="NAME"){ sec=NAME; if(nt>1) P.name=std::string(t[1]); }
+        else if(h=="ROWS") sec=ROWS;
+        else if(h=="COLUMNS") sec=COLUMNS;
+        else if(h=="RHS") sec=RHS;
+        else if(h=="RANGES") sec=RANGES;
+        else if(h=="BOUNDS") sec=BOUNDS;
+        else if(h=="ENDATA") sec=END;
+        else if(h=="OBJSENSE"){
+            sec=OBJSENSE;
+            if(nt>1) objsense(t[1]);
+        }
+        else if(h=="OBJNAME" || h=="SOS" || h=="QUADOBJ")
+            return fail("unsupported section "+std::string(h));
+        else return fail("unknown section "+std::string(h));
+        return true;
+    }
+
+    void objsense(std::string_view s){
+        if(s=="MAX" || s=="MAXIMIZE") P.obj_sense=-1;
+        else if(s=="MIN" || s=="MINIMIZE") P.obj_sense=1;
+    }
+
+    bool row_line(std::string_view* t, int nt){
+        if(nt<2) return fail("short ROWS line");
+        char type=t[0][0];
+        if(type=='N'){
+            if(obj_row.empty()) obj_row=std::string(t[1]);
+            else free_rows.intern(t[1]);    // extra free rows are dropped
+            return true;
+        }
+        if(type!='L' && type!='G' && type!='E') return fail("bad row type");
+        int r=P.rows.intern(t[1]);
+        if(r!=P.m) return fail("duplicate row "+std::string(t[1]));
+        P.m++;
+        P.sense.push_back(type);
+        return true;
+    }
+
+    bool add_entry(int col, std::string_view row, std::string_view val){
+        double v; if(!num(val,v)) return false;
+        if(row==obj_row){ P.obj[col]=v; return true; }
+        int r=P.rows.find(row);
+        if(r<0 && free_rows.find(row)>=0) return true;
+        if(r<0) return fail("unknown row "+std::string(row));
+        if(v!=0){ e_col.push_back(col); e_row.push_back(r); e_val.push_back(v); }
+        return true;
+    }
+
+    bool column_line(std::string_view* t, int nt){
+        if(nt>=3 && t[1]=="'MARKER'"){
+            if(t[2]=="'INTORG'") in_int=true;
+            else if(t[2]=="'INTEND'") in_int=false;
+            return true;
+        }
+        if(nt!=3 && nt!=5) return fail("bad COLUMNS line");
+        if(cur_col<0 || P.cols.get(cur_col)!=t[0]){
+            int j=P.cols.intern(t[0]);
+            if(j==P.n){
+                P.n++;
+                P.obj.push_back(0);
+                P.lb.push_back(0);
+                P.ub.push_back(MIP_INF);
+                P.is_int.push_back(in_int);
+            }
+            cur_col=j;
+        }
+        if(!add_entry(cur_col,t[1],t[2])) return false;
+        if(nt==5 && !add_entry(cur_col,t[3],t[4])) return false;
+        return true;
+    }
+
+    // RHS / RANGES: [set] row val [row val]
+    bool value_line(std::string_view* t, int nt, bool is_rhs){
+        int b=(nt==3||nt==5)?1:0;
+        if(nt-b!=2 && nt-b!=4) return fail("bad RHS/RANGES line");
+        for(int p=b;p<nt;p+=2){
+            double v; if(!num(t[p+1],v)) return false;
+            if(is_rhs && t[p]==obj_row){ P.obj_offset=-v; continue; }
+            int r=P.rows.find(t[p]);
+            if(r<0 && free_rows.find(t[p])>=0) continue;
+            if(r<0) return fail("unknown row "+std::string(t[p]));
+            if(is_rhs) rhs[r]=v;
+            else { rng[r]=v; has_rng[r]=1; }
+        }
+        return true;
+    }
+
+    // BOUNDS: type [set] col [val]
+    bool bound_line(std::string_view* t, int nt){
+        std::string_view ty=t[0];
+        bool needs_val=!(ty=="FR"||ty=="MI"||ty=="PL"||ty=="BV");
+        int want=needs_val?3:2;
+        int c=(nt>want)?2:1;
+        if(nt<want) return fail("short BOUNDS line");
+        int j=P.cols.find(t[c]);
+        if(j<0) return fail("unknown column "+std::string(t[c]));
+        double v=0;
+        if(needs_val && !num(t[c+1],v)) return false;
+        if(v>=MIP_INF) v=MIP_INF;
+        if(v<=-MIP_INF) v=-MIP_INF;
+        if(ty=="UP"){
+            P.ub[j]=v;
+            if(v<0 && P.lb[j]==0 && !lb_set[j]) P.lb[j]=-MIP_INF;
+        }
+        else if(ty=="LO"){ P.lb[j]=v; lb_set[j]=1; }
+        else if(ty=="FX"){ P.lb[j]=P.ub[j]=v; lb_set[j]=1; }
+        else if(ty=="FR"){ P.lb[j]=-MIP_INF; P.ub[j]=MIP_INF; lb_set[j]=1; }
+        else if(ty=="MI"){ P.lb[j]=-MIP_INF; lb_set[j]=1; }
+        else if(ty=="PL"){ P.ub[j]=MIP_INF; }
+        else if(ty=="BV"){ P.lb[j]=0; P.ub[j]=1; P.is_int[j]=1; lb_set[j]=1; }
+        else if(ty=="LI"){ P.lb[j]=v; P.is_int[j]=1; lb_set[j]=1; }
+        else if(ty=="UI"){ P.ub[j]=v; P.is_int[j]=1; }
+        else if(ty=="SC"){ P.ub[j]=v; }
+        else return fail("unknown bound type "+std::string(ty));
+        return true;
+    }
+
+    bool line(std::string_view s){
+        line_no++;
+        while(!s.empty() && (s.back()=='\r' || s.back()==' ' || s.back()=='\t')) s.remove_suffix(1);
+        if(s.empty() || s[0]=='*') return true;
+        std::string_view t[8];
+        int nt=split(s,t,8);
+        if(!nt) return true;
+        if(s[0]!=' ' && s[0]!='\t'){
+            Section prev=sec;
+            if(!header(t,nt)) return false;
+            if(prev==ROWS && sec!=ROWS) start_columns();
+            if(sec==RHS || sec==RANGES || sec==BOUNDS) start_values();
+            return true;
+        }
+        switch(sec){
+            case ROWS:     return row_line(t,nt);
+            case COLUMNS:  return column_line(t,nt);
+            case RHS:      return value_line(t,nt,true);
+            case RANGES:   return value_line(t,nt,false);
+            case BOUNDS:   return bound_line(t,nt);
+            case OBJSENSE: objsense(t[0]); return true;
+            case END:      return true;
+            default:       return fail("data outside of a section");
+        }
+    }
+
+    void start_columns(){
+        rhs.assign(P.m,0);
+        rng.assign(P.m,0);
+        has_rng.assign(P.m,0);
+    }
+
+    void start_values(){
+        if(lb_set.size()!=(size_t)P.n) lb_set.assign(P.n,0);
+    }
+
+    bool finish(){
+        if(sec!=END) return fail("missing ENDATA");
+        if(rhs.size()!=(size_t)P.m) start_columns();
+        int m=P.m, nz=(int)e_val.size();
+
+        // CSC and CSR together; rows inside each column ascending (the
+        // merge-based pair checks rely on it), already so in well-formed files
+        mip_build_matrix(P,nz,e_row.data(),e_col.data(),e_val.data());
+        std::vector<int>().swap(e_col);
+        std::vector<int>().swap(e_row);
+        std::vector<double>().swap(e_val);
+
+        P.rlo.resize(m);
+        P.rhi.resize(m);
+        for(int r=0;r<m;r++){
+            double b=rhs[r], R=rng[r];
+            switch(P.sense[r]){
+                case 'L': P.rlo[r]=-MIP_INF; P.rhi[r]=b; break;
+                case 'G': P.rlo[r]=b; P.rhi[r]=MIP_INF; break;
+                default:  P.rlo[r]=b; P.rhi[r]=b; break;
+            }
+            if(!has_rng[r]) continue;
+            if(P.sense[r]=='L') P.rlo[r]=b-std::fabs(R);
+            else if(P.sense[r]=='G') P.rhi[r]=b+std::fabs(R);
+            else if(R>0) P.rhi[r]=b+R;
+            else P.rlo[r]=b+R;
+            P.sense[r]='R';
+        }
+        if(P.obj_sense<0){
+            for(double& c:P.obj) c=-c;
+            P.obj_offset=-P.obj_offset;
+        }
+        return true;
+    }
+};
+
+inline bool ends_with(const std::string& s, const char* suf){
+    size_t L=strlen(suf);
+    return s.size()>=L && s.compare(s.size()-L,L,suf)==0;
+}
+
+// Feeds every complete line of [b,e) to the parser; returns the start of
+// the trailing partial line.
+inline const char* feed(Parser& p, const char* b, const char* e, bool& ok){
+    while(ok){
+        const char* nl=(const char*)memchr(b,'\n',(size_t)(e-b));
+        if(!nl) break;
+        ok=p.line(std::string_view(b,(size_t)(nl-b)));
+        b=nl+1;
+    }
+    return b;
+}
+
+inline bool read_mapped(Parser& p, const std::string& file){
+    int fd=open(file.c_str(),O_RDONLY);
+    if(fd<0) return p.fail("cannot open "+file);
+    struct stat st;
+    if(fstat(fd,&st)!=0){ close(fd); return p.fail("cannot stat "+file); }
+    size_t len=(size_t)st.st_size;
+    if(!len){ close(fd); return p.fail("empty file "+file); }
+    void* mem=mmap(nullptr,len,PROT_READ,MAP_PRIVATE,fd,0);
+    close(fd);
+    if(mem==MAP_FAILED) return p.fail("mmap failed for "+file);
+    madvise(mem,len,MADV_SEQUENTIAL);
+    const char* b=(const char*)mem; const char* e=b+len;
+    bool ok=true;
+    b=feed(p,b,e,ok);
+    if(ok && b<e) ok=p.line(std::string_view(b,(size_t)(e-b)));
+    munmap(mem,len);
+    return ok;
+}
+
+inline bool read_gz(Parser& p, const std::string& file){
+    gzFile g=gzopen(file.c_str(),"rb");
+    if(!g) return p.fail("cannot open "+file);
+    gzbuffer(g,1<<17);
+    const size_t CHUNK=1<<20;
+    std::vector<char> buf(CHUNK);
+    size_t have=0;
+    bool ok=true;
+    while(ok){
+        if(have==buf.size()) buf.resize(buf.size()*2);     // line longer than a chunk
+        int got=gzread(g,buf.data()+have,(unsigned)(buf.size()-have));
+        if(got<0){ ok=p.fail("gzip error in "+file); break; }
+        if(got==0){
+            if(have) ok=p.line(std::string_view(buf.data(),have));
+            break;
+        }
+        const char* e=buf.data()+have+got;
+        const char* rest=feed(p,buf.data(),e,ok);
+        have=(size_t)(e-rest);
+        memmove(buf.data(),rest,have);
+    }
+    gzclose(g);
+    return ok;
+}
+
+} // namespace mps_detail
+
+// Reads an MPS (or gzip-compressed MPS) file into P.
+inline bool read_mps(const std::string& file, MipProblem& P, std::string* err=nullptr){
+    P=MipProblem();
+    mps_detail::Parser p(P);
+    bool ok=mps_detail::ends_with(file,".gz") ? mps_detail::read_gz(p,file)
+                                              : mps_detail::read_mapped(p,file);
+    if(ok) ok=p.finish();
+    if(!ok && err) *err=p.err;
+    return ok;
+}
@@ -0,0 +1,94 @@
+// pair_gen.hpp  (header-only)
+//
+// Candidate pairs for 2-opt from the variable-interaction graph: i and j
+// are neighbours when they share a row. Only those pairs need a joint
+// feasibility check; a pair that shares no row is feasible iff both
+// single moves are, so it is covered by combining independent 1-opt moves
+// (best_combined_1opt in two_opt.hpp). Work per sweep therefore follows
+// sum_r len(r)^2 instead of n^2.
+//
+// Neighbour lists are stored CSR-style with j > i. Columns are also
+// grouped into power-of-two degree buckets so a GPU launch (or a CPU
+// chunk) sees columns of similar cost.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "mip_problem.hpp"
+
+struct PairGenOptions {
+    int max_row_len=1024;           // longer rows do not generate pairs
+    int64_t max_pairs=200000000;    // hard cap on stored pairs
+    bool int_only=false;            // only integer columns move
+};
+
+struct CandidatePairs {
+    std::vector<int64_t> ptr;       // neighbours of i: nb[ptr[i] .. ptr[i+1])
+    std::vector<int> nb;
+    std::vector<unsigned char> movable;
+    // columns ordered by degree bucket; bucket b holds degrees in
+    // [2^b, 2^(b+1)), bucket 0 also holds degree 0
+    std::vector<int> order;
+    std::vector<int> bucket_ptr;
+    bool truncated=false;           // some row was skipped or the cap hit
+
+    int64_t num_pairs() const { return (int64_t)nb.size(); }
+    int degree(int i) const { return (int)(ptr[i+1]-ptr[i]); }
+};
+
+inline int pair_bucket(int deg){
+    int b=0;
+    while(deg>1){ deg>>=1; b++; }
+    return b;
+}
+
+inline void build_candidate_pairs(const MipView& P, CandidatePairs& C, const PairGenOptions& opt=PairGenOptions()){
+    int n=P.n;
+    C.movable.assign(n,0);
+    for(int j=0;j<n;j++)
+        C.movable[j]=(P.lb[j]<P.ub[j]) && (!opt.int_only || P.is_int[j]);
+
+    C.ptr.assign(n+1,0);
+    C.nb.clear();
+    C.truncated=false;
+    std::vector<int> stamp(n,-1);
+    bool capped=false;
+    for(int i=0;i<n;i++){
+        C.ptr[i]=(int64_t)C.nb.size();
+        if(!C.movable[i] || capped) continue;
+        stamp[i]=i;
+        for(int k=P.cp[i];k<P.cp[i+1];k++){
+            int r=P.ri[k];
+            int s=P.rp[r], e=P.rp[r+1];
+            if(e-s>opt.max_row_len){ C.truncated=true; continue; }
+            // columns are ascending inside a row: start right after i
+            int q=(int)(std::upper_bound(P.ci+s,P.ci+e,i)-P.ci);
+            for(;q<e;q++){
+                int j=P.ci[q];
+                if(stamp[j]==i || !C.movable[j]) continue;
+                stamp[j]=i;
+                C.nb.push_back(j);
+            }
+        }
+        std::sort(C.nb.begin()+C.ptr[i],C.nb.end());
+        if((int64_t)C.nb.size()>opt.max_pairs){
+            C.nb.resize((size_t)C.ptr[i]);
+            C.truncated=capped=true;
+        }
+    }
+    C.ptr[n]=(int64_t)C.nb.size();
+
+    // bucket by degree (counting sort on the bucket id)
+    int nb_buckets=33;
+    C.bucket_ptr.assign(nb_buckets+1,0);
+    for(int i=0;i<n;i++) C.bucket_ptr[pair_bucket(C.degree(i))+1]++;
+    for(int b=0;b<nb_buckets;b++) C.bucket_ptr[b+1]+=C.bucket_ptr[b];
+    std::vector<int> pos(C.bucket_ptr.begin(),C.bucket_ptr.end()-1);
+    C.order.resize(n);
+    for(int i=0;i<n;i++) C.order[pos[pair_bucket(C.degree(i))]++]=i;
+    while(C.bucket_ptr.size()>2 && C.bucket_ptr[C.bucket_ptr.size()-2]==n) C.bucket_ptr.pop_back();
+}
@@ -1,48 +1,349 @@
+// parse_logs.cpp  (NO CMAKE REQUIRED)
+//
+// Parses cuOpt PDLP logs into tables for tolerance tuning.
+//
+// Compile:
+// g++ -std=c++17 -O2 parse_logs.cpp -o parse_logs -lpthread
+//
+// Usage:
+// ./parse_logs [dir|file ...] [out=DIR] [threads=N]
+//   default inputs: logs_pdlp_1e-06/*.log src/l40s_pdlp_logs_1e-6/*.log
+//
+// Output (in DIR, default .):
+//   summary.csv      one row per log: objective, time, problem size, scaling
+//                    ranges, offset, final status, residuals and gaps
+//   pdlp_iters.csv   iteration table of every log
+//   pdlp_iters.bin   the same table, columnar float64 (see TraceHeader);
+//                    column "log" is the 0-based row of summary.csv
+//
+// Each log is mapped and scanned once, line by line, with std::from_chars;
+// logs are parsed in parallel. Logs cut off before the final status report
+// get status "incomplete" and the time of their last iteration row.
+//
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
-#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
 #include <vector>
-#include <regex>
-#include <filesystem>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace fs = std::filesystem;
 using namespace std;
 
-int main() {
-    vector<string> files;
+struct TraceHeader {
+    char magic[8];          // "PDLPTRC\0"
+    uint32_t version;       // 1
+    uint32_t ncols;
+    int64_t nrows;
+    // then char name[16] per column, then ncols x nrows doubles
+};
+
+static const char* TRACE_COLS[]={"log","iter","primal_obj","dual_obj","gap","primal_res","dual_res","time"};
+constexpr int NTRACE=8;
+
+struct LogInfo {
+    string file, set, instance, device, status="incomplete";
+    double tol=NAN, time_limit=NAN;
+    long long rows=-1, cols=-1, ints=-1, nnz=-1;
+    double range[4][2]={{NAN,NAN},{NAN,NAN},{NAN,NAN},{NAN,NAN}};   // obj, matrix, rhs, bounds
+    double offset=NAN, scaling=NAN;
+    double primal_obj=NAN, dual_obj=NAN;
+    double gap[2]={NAN,NAN}, pinf[2]={NAN,NAN}, dinf[2]={NAN,NAN};  // abs, rel
+    double objective=NAN, status_obj=NAN;
+    long long iterations=-1;
+    double solve_time=NAN, total_time=NAN;
+    bool range_warning=false;
+    vector<array<double,NTRACE-1>> trace;   // iter .. time
+};
+
+// ---- scanning helpers -------------------------------------------------------
+
+static bool starts(string_view s, string_view p){ return s.size()>=p.size() && s.compare(0,p.size(),p)==0; }
+
+static void skip_ws(string_view& s){
+    while(!s.empty() && (s.front()==' ' || s.front()=='\t')) s.remove_prefix(1);
+}
+
+// Reads a number at the front of s (after blanks, '+' allowed) and consumes
+// it; stops at the first character that is not part of it, so the trailing
+// '.' of "Objective = -242520.789097." is left behind.
+static bool num(string_view& s, double& v){
+    skip_ws(s);
+    if(!s.empty() && s.front()=='+') s.remove_prefix(1);
+    auto r=from_chars(s.data(),s.data()+s.size(),v);
+    if(r.ec!=errc()) return false;
+    s.remove_prefix((size_t)(r.ptr-s.data()));
+    return true;
+}
+
+static bool num(string_view& s, long long& v){
+    skip_ws(s);
+    auto r=from_chars(s.data(),s.data()+s.size(),v);
+    if(r.ec!=errc()) return false;
+    s.remove_prefix((size_t)(r.ptr-s.data()));
+    return true;
+}
+
+// consumes s up to and including key
+static bool after(string_view& s, string_view key){
+    size_t p=s.find(key);
+    if(p==string_view::npos) return false;
+    s.remove_prefix(p+key.size());
+    return true;
+}
+
+static string_view trim(string_view s){
+    skip_ws(s);
+    while(!s.empty() && (s.back()==' ' || s.back()=='\r')) s.remove_suffix(1);
+    return s;
+}
+
+// "[5e-01, 6e+03]"
+static void range(string_view s, double r[2]){
+    if(after(s,"[") && num(s,r[0]) && after(s,",")) num(s,r[1]);
+}
+
+// "+3.42e+01 / +7.04e-05"
+static void abs_rel(string_view s, double r[2]){
+    if(num(s,r[0]) && after(s,"/")) num(s,r[1]);
+}
+
+// "   1000 -2.40758096e+05 -2.41208954e+05  4.51e+02   6.28e-02     9.07e+02   0.172s"
+static bool trace_row(string_view s, array<double,NTRACE-1>& row){
+    for(int k=0;k<NTRACE-1;k++) if(!num(s,row[k])) return false;
+    return true;
+}
+
+static void parse_line(string_view ln, LogInfo& L, bool& in_table){
+    ln=trim(ln);
+    if(ln.empty()) return;
+
+    if(in_table){
+        array<double,NTRACE-1> row;
+        if(ln.front()>='0' && ln.front()<='9' && trace_row(ln,row)){ L.trace.push_back(row); return; }
+        in_table=false;
+    }
+    if(starts(ln,"Iter ")){ in_table=true; return; }
 
-    for (const auto& entry : fs::directory_iterator("logs_pdlp_1e-06")) {
-        if (entry.path().string().find("relaxed_") != string::npos && 
-            entry.path().extension() == ".log") {
-            files.push_back(entry.path().string());
+    string_view s=ln;
+    if(starts(ln,"Setting parameter absolute_primal_tolerance to ")){ s.remove_prefix(47); num(s,L.tol); }
+    else if(starts(ln,"Setting parameter time_limit to ")){ s.remove_prefix(32); num(s,L.time_limit); }
+    else if(starts(ln,"CUDA ")){
+        if(after(s,"device: ")){
+            size_t p=s.find(" (ID");
+            L.device=string(s.substr(0,p));
         }
     }
+    else if(starts(ln,"Solving a problem with ")){
+        s.remove_prefix(23);
+        num(s,L.rows);
+        if(after(s,",")) num(s,L.cols);
+        if(after(s,"(")) num(s,L.ints);
+        if(after(s,"and")) num(s,L.nnz);
+    }
+    else if(starts(ln,"Objective coefficents range:"))         range(s,L.range[0]);
+    else if(starts(ln,"Constraint matrix coefficients range:")) range(s,L.range[1]);
+    else if(starts(ln,"Constraint rhs / bounds range:"))        range(s,L.range[2]);
+    else if(starts(ln,"Variable bounds range:"))                range(s,L.range[3]);
+    else if(starts(ln,"Objective offset ")){
+        s.remove_prefix(17);
+        num(s,L.offset);
+        if(after(s,"scaling_factor")) num(s,L.scaling);
+    }
+    else if(starts(ln,"Warning: input problem contains a large range")) L.range_warning=true;
+    else if(starts(ln,"LP Solver status:")) L.status=string(trim(s.substr(17)));
+    else if(starts(ln,"Primal objective:")){ s.remove_prefix(17); num(s,L.primal_obj); }
+    else if(starts(ln,"Dual objective:")){ s.remove_prefix(15); num(s,L.dual_obj); }
+    else if(starts(ln,"Duality gap (abs/rel):"))          abs_rel(s.substr(22),L.gap);
+    else if(starts(ln,"Primal infeasibility (abs/rel):")) abs_rel(s.substr(31),L.pinf);
+    else if(starts(ln,"Dual infeasibility (abs/rel):"))   abs_rel(s.substr(29),L.dinf);
+    else if(starts(ln,"Status: ")){
+        // "Status: Optimal   Objective: v  Iterations: n  Time: t s, Total time t s"
+        string_view st=trim(s.substr(8));
+        L.status=string(st.substr(0,st.find(' ')));
+        if(after(s,"Objective:")) num(s,L.status_obj);
+        if(after(s,"Iterations:")) num(s,L.iterations);
+        if(after(s,"Time:")) num(s,L.solve_time);
+        if(after(s,"Total time")) num(s,L.total_time);
+    }
+    else if(starts(ln,"Solve completed")){                // full-precision objective
+        if(after(s,"Objective = ")) num(s,L.objective);
+    }
+    else if(starts(ln,"Objective value:")){ s.remove_prefix(16); num(s,L.objective); }
+}
 
-    sort(files.begin(), files.end());
+static bool parse_log(LogInfo& L){
+    int fd=open(L.file.c_str(),O_RDONLY);
+    if(fd<0) return false;
+    struct stat st;
+    if(fstat(fd,&st)!=0){ close(fd); return false; }
+    size_t len=(size_t)st.st_size;
+    if(!len){ close(fd); return true; }
+    void* mem=mmap(nullptr,len,PROT_READ,MAP_PRIVATE,fd,0);
+    close(fd);
+    if(mem==MAP_FAILED) return false;
+    madvise(mem,len,MADV_SEQUENTIAL);
 
-    ofstream csv("summary.csv");
-    csv << "filename,optimal_objective,time\n";
+    const char* p=(const char*)mem; const char* e=p+len;
+    bool in_table=false;
+    while(p<e){
+        const char* nl=(const char*)memchr(p,'\n',(size_t)(e-p));
+        if(!nl) nl=e;
+        parse_line(string_view(p,(size_t)(nl-p)),L,in_table);
+        p=nl+1;
+    }
+    munmap(mem,len);
 
-    regex objRegex(R"(Objective = ([\-\d\.]+))");
-    regex timeRegex(R"(Time: ([\d\.]+)s)");
+    if(std::isnan(L.objective)) L.objective=L.status_obj;
+    if(std::isnan(L.solve_time) && !L.trace.empty()) L.solve_time=L.trace.back()[NTRACE-2];
+    return true;
+}
 
-    for (const auto& file : files) {
-        ifstream f(file);
-        string content((istreambuf_iterator<char>(f)), {});
-        smatch objMatch, timeMatch;
+// ---- output -----------------------------------------------------------------
 
-        string objective = "";
-        string time = "";
+struct Out {
+    string buf;
+    char tmp[64];
+    Out& d(double v){                         // NaN / missing -> empty field
+        if(!std::isnan(v)){ auto r=to_chars(tmp,tmp+sizeof(tmp),v); buf.append(tmp,r.ptr); }
+        return *this;
+    }
+    Out& i(long long v){
+        if(v>=0){ auto r=to_chars(tmp,tmp+sizeof(tmp),v); buf.append(tmp,r.ptr); }
+        return *this;
+    }
+    Out& s(string_view v){ buf.append(v); return *this; }
+    Out& c(){ buf+=','; return *this; }
+    Out& nl(){ buf+='\n'; return *this; }
+};
 
-        if (regex_search(content, objMatch, objRegex)) {
-            objective = objMatch[1];
-        }
-        if (regex_search(content, timeMatch, timeRegex)) {
-            time = timeMatch[1];
+static bool save(const string& path, const string& data){
+    FILE* f=fopen(path.c_str(),"wb");
+    if(!f) return false;
+    fwrite(data.data(),1,data.size(),f);
+    return fclose(f)==0;
+}
+
+static void write_summary(const string& path, const vector<LogInfo>& logs){
+    Out o;
+    o.s("filename,optimal_objective,time,set,instance,device,tolerance,rows,cols,nnz,"
+        "obj_lo,obj_hi,matrix_lo,matrix_hi,rhs_lo,rhs_hi,bounds_lo,bounds_hi,"
+        "offset,status,iterations,total_time,primal_obj,dual_obj,gap_abs,gap_rel,"
+        "primal_inf_abs,primal_inf_rel,dual_inf_abs,dual_inf_rel,trace_rows,range_warning\n");
+    for(const LogInfo& L:logs){
+        o.s(L.file).c().d(L.objective).c().d(L.solve_time).c().s(L.set).c().s(L.instance).c()
+         .s(L.device).c().d(L.tol).c().i(L.rows).c().i(L.cols).c().i(L.nnz);
+        for(auto& r:L.range) o.c().d(r[0]).c().d(r[1]);
+        o.c().d(L.offset).c().s(L.status).c().i(L.iterations).c().d(L.total_time).c()
+         .d(L.primal_obj).c().d(L.dual_obj).c().d(L.gap[0]).c().d(L.gap[1]).c()
+         .d(L.pinf[0]).c().d(L.pinf[1]).c().d(L.dinf[0]).c().d(L.dinf[1]).c()
+         .i((long long)L.trace.size()).c().i(L.range_warning).nl();
+    }
+    if(!save(path,o.buf)) cerr << "Cannot write " << path << "\n";
+}
+
+static void write_trace_csv(const string& path, const vector<LogInfo>& logs){
+    Out o;
+    o.s("filename,iter,primal_obj,dual_obj,gap,primal_res,dual_res,time\n");
+    for(const LogInfo& L:logs)
+        for(auto& r:L.trace){
+            o.s(L.file);
+            for(double v:r) o.c().d(v);
+            o.nl();
         }
+    if(!save(path,o.buf)) cerr << "Cannot write " << path << "\n";
+}
+
+static void write_trace_bin(const string& path, const vector<LogInfo>& logs){
+    int64_t n=0;
+    for(auto& L:logs) n+=(int64_t)L.trace.size();
+    TraceHeader h;
+    memset(&h,0,sizeof(h));
+    memcpy(h.magic,"PDLPTRC\0",8);
+    h.version=1; h.ncols=NTRACE; h.nrows=n;
 
-        csv << file << "," << objective << "," << time << "\n";
+    string buf((const char*)&h,sizeof(h));
+    for(const char* c:TRACE_COLS){
+        char name[16]={0};
+        strncpy(name,c,sizeof(name)-1);
+        buf.append(name,sizeof(name));
     }
+    vector<double> col((size_t)n);
+    for(int k=0;k<NTRACE;k++){
+        size_t r=0;
+        for(size_t l=0;l<logs.size();l++)
+            for(auto& row:logs[l].trace) col[r++]= k==0 ? (double)l : row[k-1];
+        buf.append((const char*)col.data(),col.size()*sizeof(double));
+    }
+    if(!save(path,buf)) cerr << "Cannot write " << path << "\n";
+}
+
+int main(int argc, char** argv){
+    vector<string> inputs;
+    string out=".";
+    int threads=(int)thread::hardware_concurrency();
+    for(int a=1;a<argc;a++){
+        string s=argv[a];
+        if(s.rfind("out=",0)==0) out=s.substr(4);
+        else if(s.rfind("threads=",0)==0) threads=atoi(s.c_str()+8);
+        else inputs.push_back(s);
+    }
+    if(inputs.empty()) inputs={"logs_pdlp_1e-06","src/l40s_pdlp_logs_1e-6"};
+    if(threads<1) threads=1;
+
+    vector<LogInfo> logs;
+    for(const string& in:inputs){
+        error_code ec;
+        vector<string> files;
+        if(fs::is_directory(in,ec)){
+            for(const auto& e:fs::directory_iterator(in,ec))
+                if(e.path().extension()==".log") files.push_back(e.path().string());
+            sort(files.begin(),files.end());
+        } else files.push_back(in);
+        for(auto& f:files){
+            LogInfo L;
+            L.file=f;
+            fs::path p(f);
+            L.set=p.parent_path().filename().string();
+            L.instance=p.stem().string();
+            logs.push_back(std::move(L));
+        }
+    }
+    if(logs.empty()){ cerr << "No logs found\n"; return 1; }
+
+    atomic<size_t> next{0};
+    atomic<int> bad{0};
+    vector<thread> th;
+    for(int t=0;t<min<int>(threads,(int)logs.size());t++)
+        th.emplace_back([&]{
+            for(size_t i;(i=next++)<logs.size();)
+                if(!parse_log(logs[i])){ cerr << "Cannot read " << logs[i].file << "\n"; bad++; }
+        });
+    for(auto& t:th) t.join();
+
+    error_code ec;
+    fs::create_directories(out,ec);
+    write_summary(out+"/summary.csv",logs);
+    write_trace_csv(out+"/pdlp_iters.csv",logs);
+    write_trace_bin(out+"/pdlp_iters.bin",logs);
 
-    cout << "CSV created: summary.csv" << endl;
-    return 0;
+    size_t rows=0, done=0;
+    for(auto& L:logs){ rows+=L.trace.size(); done+=L.status!="incomplete"; }
+    cout << "Parsed " << logs.size() << " logs (" << done << " finished), "
+         << rows << " iteration rows -> " << out << "/summary.csv, pdlp_iters.csv, pdlp_iters.bin\n";
+    return bad ? 1 : 0;
 }
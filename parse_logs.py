@@ -1,3 +1,6 @@
+# Quick three-column summary (filename, objective, time). The full
+# summary.csv is written by ./parse_logs (parse_logs.cpp).
+
 import glob
 import csv
 import re
@@ -6,7 +9,7 @@ import re
 files = sorted(glob.glob("logs_pdlp_1e-06/relaxed_*.log"))
 
 # 2) Prepare CSV output
-with open("summary.csv", "w", newline="") as csvfile:
+with open("summary_py.csv", "w", newline="") as csvfile:
     writer = csv.writer(csvfile)
     writer.writerow(["filename", "optimal_objective", "time"])  # header
 
@@ -15,7 +18,7 @@ with open("summary.csv", "w", newline="") as csvfile:
             content = f.read()
 
             # 3) Regex to extract Optimal objective
-            obj_match = re.search(r"Objective = ([\-\d\.]+)", content)
+            obj_match = re.search(r"Objective = (-?\d+(?:\.\d+)?)", content)
 
             # 4) Regex to extract Time (last Time: value in seconds)
             time_match = re.search(r"Time: ([\d\.]+)s", content)
@@ -26,4 +29,4 @@ with open("summary.csv", "w", newline="") as csvfile:
             # 5) Write row
             writer.writerow([file, objective, time])
 
-print("CSV created successfully: summary.csv")
+print("CSV created successfully: summary_py.csv")
@@ -0,0 +1,617 @@
+// presolve.hpp  (header-only, link with -lpthread)
+//
+// Primal presolve on the CSR/CSC arrays of a MipView. Reductions, repeated
+// in rounds until nothing changes:
+//
+//   - activity-based bound tightening (domain propagation)
+//   - redundant, empty and singleton rows (a singleton row becomes a bound)
+//   - fixed and empty columns, continuous zero-cost singleton columns
+//   - duplicate (parallel) rows, parallel columns
+//
+// Propagation works like the GPU scheme of domainPropGPU.pdf: a round
+// first computes the min/max activity of every row in parallel over row
+// blocks, then derives new bounds in parallel over column blocks from
+// the activities of that round (Jacobi style), so no two threads write
+// the same bound. Bounds derived from one round's activities are only
+// looser than exact ones, never wrong.
+//
+// The reduced model is a restriction of the original: every point feasible
+// for it maps back (postsolve) to a feasible point with the same objective.
+// Reductions that need duals are not done.
+//
+//   Presolved R;
+//   if(presolve(P, R) && !R.infeasible){
+//       ... work on R.model.view() ...
+//       std::vector<double> x = R.postsolve(xr);
+//   }
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "mip_problem.hpp"
+
+struct PresolveOptions {
+    int threads=0;                  // 0 = hardware_concurrency
+    int max_rounds=50;
+    double tol=1e-9;                // redundancy / fixing tolerance
+    double inf_tol=1e-6;            // infeasibility is only declared beyond this
+    bool dup_rows=true;
+    bool parallel_cols=true;
+};
+
+struct PresolveStats {
+    int rounds=0;
+    int rows_removed=0, cols_removed=0;
+    int tightened=0;                // bound changes from propagation
+    int fixed=0, empty_cols=0, singleton_cols=0;
+    int redundant_rows=0, empty_rows=0, singleton_rows=0;
+    int dup_rows=0, parallel_cols=0;
+};
+
+// One undo step; applied in reverse order by postsolve().
+struct PostsolveOp {
+    enum Kind { FIX, SINGLETON_COL, PARALLEL_COL } kind;
+    int j=-1, k=-1;
+    double v=0;                     // FIX: value; PARALLEL_COL: scale s
+    double a=0, rlo=0, rhi=0;       // SINGLETON_COL: coefficient, row bounds at removal
+    double lj=0, uj=0, lk=0, uk=0;  // column bounds at removal
+    int64_t e0=0, e1=0;             // SINGLETON_COL: other row entries in post_idx/post_val
+};
+
+struct Presolved {
+    MipProblem model;               // reduced model
+    std::vector<int> col_orig;      // reduced column -> original column
+    std::vector<int> row_orig;      // reduced row -> original row
+    int n_orig=0, m_orig=0;
+    bool infeasible=false;
+    PresolveStats stats;
+
+    std::vector<PostsolveOp> ops;
+    std::vector<int> post_idx;
+    std::vector<double> post_val;
+    std::vector<double> removed_val;    // provisional values of removed columns
+
+    // reduced point -> original point
+    std::vector<double> postsolve(const std::vector<double>& xr) const {
+        std::vector<double> x(removed_val);
+        for(size_t j=0;j<col_orig.size();j++) x[col_orig[j]]=xr[j];
+        for(size_t t=ops.size();t-->0;){
+            const PostsolveOp& o=ops[t];
+            switch(o.kind){
+            case PostsolveOp::FIX:
+                x[o.j]=o.v;
+                break;
+            case PostsolveOp::SINGLETON_COL: {
+                // x_j in [lj, uj] with rlo <= a x_j + rest <= rhi; when the
+                // rest is off (infeasible xr), the closest in-bounds value
+                double s=0;
+                for(int64_t e=o.e0;e<o.e1;e++) s+=post_val[e]*x[post_idx[e]];
+                double b1=o.rlo>-MIP_INF ? (o.rlo-s)/o.a : (o.a>0?-MIP_INF:MIP_INF);
+                double b2=o.rhi<MIP_INF ? (o.rhi-s)/o.a : (o.a>0?MIP_INF:-MIP_INF);
+                if(b1>b2) std::swap(b1,b2);
+                x[o.j]=std::min(std::max(std::min(std::max(0.0,b1),b2),o.lj),o.uj);
+                break;
+            }
+            case PostsolveOp::PARALLEL_COL: {
+                // y = x_j + s x_k  ->  x_k in [lk, uk] with y - s x_k in [lj, uj]
+                double y=x[o.j], s=o.v;
+                double b1=(y-o.uj)/s, b2=(y-o.lj)/s;
+                if(b1>b2) std::swap(b1,b2);
+                double lo=std::max(o.lk,b1), hi=std::min(o.uk,b2);
+                double xk= lo>-MIP_INF ? lo : (hi<MIP_INF ? hi : 0.0);
+                if(lo<=0 && 0<=hi) xk=0;
+                x[o.k]=xk;
+                x[o.j]=y-s*xk;
+                break;
+            }
+            }
+        }
+        return x;
+    }
+
+    // original point -> reduced point (e.g. a stored relaxation)
+    std::vector<double> reduce(const std::vector<double>& x0) const {
+        std::vector<double> x(x0);
+        for(const PostsolveOp& o:ops)
+            if(o.kind==PostsolveOp::PARALLEL_COL) x[o.j]+=o.v*x[o.k];
+        std::vector<double> xr(col_orig.size());
+        for(size_t j=0;j<col_orig.size();j++) xr[j]=x[col_orig[j]];
+        return xr;
+    }
+};
+
+namespace presolve_detail {
+
+inline bool finite_lo(double v){ return v>-MIP_INF; }
+inline bool finite_hi(double v){ return v<MIP_INF; }
+
+// hash key of a coefficient ratio, equal for ratios equal to ~1e-9
+inline uint64_t ratio_key(double v){
+    if(std::fabs(v)<1e9) return (uint64_t)std::llround(v*1e9);
+    uint64_t u; memcpy(&u,&v,sizeof(u));
+    return u;
+}
+
+inline uint64_t mix(uint64_t h, uint64_t v){ return (h^v)*1099511628211ull; }
+
+template<class F>
+inline void parallel_blocks(int n, int threads, F&& f){
+    if(threads<=1 || n<4096){ f(0,n); return; }
+    std::vector<std::thread> th;
+    for(int t=1;t<threads;t++)
+        th.emplace_back([&,t]{ f((int)((int64_t)n*t/threads),(int)((int64_t)n*(t+1)/threads)); });
+    f(0,(int)((int64_t)n/threads));
+    for(auto& t:th) t.join();
+}
+
+// Working copy of the model: bounds change, rows and columns die, entries
+// of dead columns are skipped.
+struct Work {
+    const MipView& P;
+    PresolveOptions opt;
+    int threads;
+
+    std::vector<double> lb, ub, rlo, rhi, obj;
+    std::vector<unsigned char> is_int, col_alive, row_alive;
+    double offset=0;
+
+    // per round
+    std::vector<double> minact, maxact, slb, sub;   // sub/slb: bounds seen by the activities
+    std::vector<int> ninf_min, ninf_max, row_len, col_len;
+
+    Presolved& R;
+    PresolveStats& st;
+
+    Work(const MipView& p, const PresolveOptions& o, Presolved& r)
+        : P(p), opt(o), R(r), st(r.stats) {
+        threads=o.threads>0 ? o.threads : (int)std::thread::hardware_concurrency();
+        if(threads<1) threads=1;
+        lb.assign(P.lb,P.lb+P.n); ub.assign(P.ub,P.ub+P.n);
+        rlo.assign(P.rlo,P.rlo+P.m); rhi.assign(P.rhi,P.rhi+P.m);
+        obj.assign(P.obj,P.obj+P.n);
+        is_int.assign(P.is_int,P.is_int+P.n);
+        col_alive.assign(P.n,1); row_alive.assign(P.m,1);
+        offset=P.obj_offset;
+        for(int j=0;j<P.n;j++) if(is_int[j]) round_int(j);
+    }
+
+    void round_int(int j){
+        if(finite_lo(lb[j])) lb[j]=std::ceil(lb[j]-1e-6);
+        if(finite_hi(ub[j])) ub[j]=std::floor(ub[j]+1e-6);
+    }
+
+    bool bad_bounds(int j) const { return lb[j]>ub[j]+opt.inf_tol; }
+
+    // ---- activities (parallel over rows) ----
+    void activities(){
+        slb=lb; sub=ub;
+        minact.assign(P.m,0); maxact.assign(P.m,0);
+        ninf_min.assign(P.m,0); ninf_max.assign(P.m,0); row_len.assign(P.m,0);
+        parallel_blocks(P.m,threads,[&](int r0,int r1){
+            for(int r=r0;r<r1;r++){
+                if(!row_alive[r]) continue;
+                double mn=0, mx=0; int im=0, iM=0, len=0;
+                for(int q=P.rp[r];q<P.rp[r+1];q++){
+                    int j=P.ci[q];
+                    if(!col_alive[j]) continue;
+                    double a=P.av[q];
+                    len++;
+                    double l=slb[j], u=sub[j];
+                    if(a>0){
+                        if(finite_lo(l)) mn+=a*l; else im++;
+                        if(finite_hi(u)) mx+=a*u; else iM++;
+                    } else {
+                        if(finite_hi(u)) mn+=a*u; else im++;
+                        if(finite_lo(l)) mx+=a*l; else iM++;
+                    }
+                }
+                minact[r]=mn; maxact[r]=mx; ninf_min[r]=im; ninf_max[r]=iM; row_len[r]=len;
+            }
+        });
+    }
+
+    // ---- bound derivation (parallel over columns) ----
+    // new bounds in nlb/nub; returns nothing, the caller compares
+    void derive(std::vector<double>& nlb, std::vector<double>& nub){
+        nlb=lb; nub=ub;
+        parallel_blocks(P.n,threads,[&](int j0,int j1){
+            for(int j=j0;j<j1;j++){
+                if(!col_alive[j]) continue;
+                double l=lb[j], u=ub[j];
+                for(int q=P.cp[j];q<P.cp[j+1];q++){
+                    int r=P.ri[q];
+                    if(!row_alive[r]) continue;
+                    double a=P.cv[q];
+                    // contribution of j to the row activities of this round
+                    double cmin, cmax; bool imin, imax;
+                    if(a>0){
+                        imin=!finite_lo(slb[j]); cmin=imin?0:a*slb[j];
+                        imax=!finite_hi(sub[j]); cmax=imax?0:a*sub[j];
+                    } else {
+                        imin=!finite_hi(sub[j]); cmin=imin?0:a*sub[j];
+                        imax=!finite_lo(slb[j]); cmax=imax?0:a*slb[j];
+                    }
+                    // residual min / max activity without j
+                    int rimin=ninf_min[r]-imin, rimax=ninf_max[r]-imax;
+                    double resmin=minact[r]-cmin, resmax=maxact[r]-cmax;
+                    // a x_j <= rhi - resmin,  a x_j >= rlo - resmax
+                    if(finite_hi(rhi[r]) && rimin==0){
+                        double b=(rhi[r]-resmin)/a;
+                        if(a>0) u=std::min(u,b); else l=std::max(l,b);
+                    }
+                    if(finite_lo(rlo[r]) && rimax==0){
+                        double b=(rlo[r]-resmax)/a;
+                        if(a>0) l=std::max(l,b); else u=std::min(u,b);
+                    }
+                }
+                if(is_int[j]){
+                    if(finite_lo(l)) l=std::ceil(l-1e-6);
+                    if(finite_hi(u)) u=std::floor(u+1e-6);
+                } else {
+                    // continuous: only worthwhile changes, kept slightly loose
+                    double range=finite_lo(lb[j]) && finite_hi(ub[j]) ? ub[j]-lb[j] : 0;
+                    double w=1e-3*(1+range);
+                    if(l>lb[j]+w && std::fabs(l)<1e9) l-=1e-9*(1+std::fabs(l)); else l=lb[j];
+                    if(u<ub[j]-w && std::fabs(u)<1e9) u+=1e-9*(1+std::fabs(u)); else u=ub[j];
+                }
+                nlb[j]=std::max(lb[j],l);
+                nub[j]=std::min(ub[j],u);
+            }
+        });
+    }
+
+    // ---- column removal ----
+    void remove_col(int j){
+        col_alive[j]=0;
+        st.cols_removed++;
+    }
+
+    // x_j = v: rows shift, objective constant grows
+    void fix_col(int j, double v){
+        PostsolveOp o; o.kind=PostsolveOp::FIX; o.j=j; o.v=v;
+        R.ops.push_back(o);
+        offset+=obj[j]*v;
+        for(int q=P.cp[j];q<P.cp[j+1];q++){
+            int r=P.ri[q];
+            if(!row_alive[r]) continue;
+            double d=P.cv[q]*v;
+            if(finite_lo(rlo[r])) rlo[r]-=d;
+            if(finite_hi(rhi[r])) rhi[r]-=d;
+        }
+        lb[j]=ub[j]=v;
+        remove_col(j);
+        st.fixed++;
+    }
+
+    void remove_row(int r){
+        row_alive[r]=0;
+        st.rows_removed++;
+    }
+
+    // returns false when infeasible
+    bool row_checks(bool& changed){
+        for(int r=0;r<P.m;r++){
+            if(!row_alive[r]) continue;
+            // infeasible?
+            if(finite_hi(rhi[r]) && ninf_min[r]==0 && minact[r]>rhi[r]+opt.inf_tol*(1+std::fabs(rhi[r]))) return false;
+            if(finite_lo(rlo[r]) && ninf_max[r]==0 && maxact[r]<rlo[r]-opt.inf_tol*(1+std::fabs(rlo[r]))) return false;
+            if(row_len[r]==0){
+                if((finite_lo(rlo[r]) && rlo[r]>opt.inf_tol) || (finite_hi(rhi[r]) && rhi[r]<-opt.inf_tol)) return false;
+                remove_row(r); st.empty_rows++; changed=true;
+                continue;
+            }
+            bool hi_red=!finite_hi(rhi[r]) || (ninf_max[r]==0 && maxact[r]<=rhi[r]+opt.tol);
+            bool lo_red=!finite_lo(rlo[r]) || (ninf_min[r]==0 && minact[r]>=rlo[r]-opt.tol);
+            if(hi_red && lo_red){
+                remove_row(r); st.redundant_rows++; changed=true;
+                continue;
+            }
+            if(row_len[r]==1){
+                int j=-1; double a=0;
+                for(int q=P.rp[r];q<P.rp[r+1];q++) if(col_alive[P.ci[q]]){ j=P.ci[q]; a=P.av[q]; break; }
+                double l=-MIP_INF, u=MIP_INF;
+                if(finite_lo(rlo[r])){ if(a>0) l=rlo[r]/a; else u=rlo[r]/a; }
+                if(finite_hi(rhi[r])){ if(a>0) u=rhi[r]/a; else l=rhi[r]/a; }
+                if(is_int[j]){
+                    if(finite_lo(l)) l=std::ceil(l-1e-6);
+                    if(finite_hi(u)) u=std::floor(u+1e-6);
+                }
+                lb[j]=std::max(lb[j],l);
+                ub[j]=std::min(ub[j],u);
+                if(bad_bounds(j)) return false;
+                if(lb[j]>ub[j]) lb[j]=ub[j]=is_int[j] ? std::round(0.5*(lb[j]+ub[j])) : 0.5*(lb[j]+ub[j]);
+                remove_row(r); st.singleton_rows++; changed=true;
+            }
+        }
+        return true;
+    }
+
+    // fixed columns, empty columns, zero-cost continuous singleton columns
+    bool col_checks(bool& changed){
+        col_len.assign(P.n,0);
+        parallel_blocks(P.n,threads,[&](int j0,int j1){
+            for(int j=j0;j<j1;j++){
+                if(!col_alive[j]) continue;
+                int c=0;
+                for(int q=P.cp[j];q<P.cp[j+1];q++) c+=row_alive[P.ri[q]];
+                col_len[j]=c;
+            }
+        });
+        for(int j=0;j<P.n;j++){
+            if(!col_alive[j]) continue;
+            if(bad_bounds(j)) return false;
+            if(ub[j]-lb[j]<=opt.tol){
+                // continuous bounds may be loosened by 1e-9; take the middle
+                fix_col(j,is_int[j]?std::round(lb[j]):0.5*(lb[j]+ub[j]));
+                changed=true;
+                continue;
+            }
+            double c=obj[j];
+            if(col_len[j]==0){
+                double v;
+                if(c>0) v=lb[j];
+                else if(c<0) v=ub[j];
+                else v=std::min(std::max(0.0,lb[j]),ub[j]);
+                if(std::fabs(v)>=MIP_INF) continue;        // unbounded direction, keep
+                fix_col(j,v);
+                st.fixed--; st.empty_cols++;
+                changed=true;
+                continue;
+            }
+            if(col_len[j]==1 && c==0 && !is_int[j]) remove_singleton_col(j), changed=true;
+        }
+        return true;
+    }
+
+    // a x_j + rest in [rlo, rhi], x_j in [l, u]  ->  rest in [rlo - max(a x_j), rhi - min(a x_j)]
+    void remove_singleton_col(int j){
+        int r=-1; double a=0;
+        for(int q=P.cp[j];q<P.cp[j+1];q++) if(row_alive[P.ri[q]]){ r=P.ri[q]; a=P.cv[q]; break; }
+        PostsolveOp o; o.kind=PostsolveOp::SINGLETON_COL;
+        o.j=j; o.a=a; o.rlo=rlo[r]; o.rhi=rhi[r]; o.lj=lb[j]; o.uj=ub[j];
+        o.e0=(int64_t)R.post_idx.size();
+        for(int q=P.rp[r];q<P.rp[r+1];q++){
+            int k=P.ci[q];
+            if(k==j || !col_alive[k]) continue;
+            R.post_idx.push_back(k); R.post_val.push_back(P.av[q]);
+        }
+        o.e1=(int64_t)R.post_idx.size();
+        R.ops.push_back(o);
+
+        double amin = a>0 ? (finite_lo(lb[j])?a*lb[j]:-MIP_INF) : (finite_hi(ub[j])?a*ub[j]:-MIP_INF);
+        double amax = a>0 ? (finite_hi(ub[j])?a*ub[j]:MIP_INF)  : (finite_lo(lb[j])?a*lb[j]:MIP_INF);
+        if(finite_lo(rlo[r])) rlo[r] = amax<MIP_INF ? rlo[r]-amax : -MIP_INF;
+        if(finite_hi(rhi[r])) rhi[r] = amin>-MIP_INF ? rhi[r]-amin : MIP_INF;
+        remove_col(j);
+        st.singleton_cols++;
+    }
+
+    // ---- duplicate rows ----
+    // Rows with the same pattern and proportional coefficients; the bounds
+    // of the others are intersected into the first.
+    bool duplicate_rows(bool& changed){
+        std::vector<uint64_t> h(P.m,0);
+        std::vector<double> lead(P.m,0);
+        parallel_blocks(P.m,threads,[&](int r0,int r1){
+            for(int r=r0;r<r1;r++){
+                if(!row_alive[r]) continue;
+                uint64_t x=1469598103934665603ull;
+                double s=0;
+                for(int q=P.rp[r];q<P.rp[r+1];q++){
+                    int j=P.ci[q];
+                    if(!col_alive[j]) continue;
+                    if(s==0) s=P.av[q];
+                    x=mix(mix(x,(uint64_t)j),ratio_key(P.av[q]/s));
+                }
+                h[r]=x; lead[r]=s;
+            }
+        });
+        std::vector<int> ord;
+        for(int r=0;r<P.m;r++) if(row_alive[r]) ord.push_back(r);
+        std::sort(ord.begin(),ord.end(),[&](int a,int b){ return h[a]!=h[b] ? h[a]<h[b] : a<b; });
+        for(size_t i=0;i<ord.size();){
+            size_t e=i+1;
+            while(e<ord.size() && h[ord[e]]==h[ord[i]]) e++;
+            for(size_t a=i;a<e;a++){
+                int r1=ord[a];
+                if(!row_alive[r1]) continue;
+                for(size_t b=a+1;b<e;b++){
+                    int r2=ord[b];
+                    if(!row_alive[r2] || !same_row(r1,r2,lead[r1],lead[r2])) continue;
+                    // row r2 = lambda * row r1
+                    double lam=lead[r2]/lead[r1];
+                    double lo=rlo[r2], hi=rhi[r2];
+                    double nlo = lam>0 ? (finite_lo(lo)?lo/lam:-MIP_INF) : (finite_hi(hi)?hi/lam:-MIP_INF);
+                    double nhi = lam>0 ? (finite_hi(hi)?hi/lam:MIP_INF)  : (finite_lo(lo)?lo/lam:MIP_INF);
+                    rlo[r1]=std::max(rlo[r1],nlo);
+                    rhi[r1]=std::min(rhi[r1],nhi);
+                    if(rlo[r1]>rhi[r1]+opt.inf_tol*(1+std::fabs(rhi[r1]))) return false;
+                    if(rlo[r1]>rhi[r1]) rlo[r1]=rhi[r1];
+                    remove_row(r2); st.dup_rows++; changed=true;
+                }
+            }
+            i=e;
+        }
+        return true;
+    }
+
+    bool same_row(int r1, int r2, double s1, double s2) const {
+        int q1=P.rp[r1], q2=P.rp[r2];
+        while(true){
+            while(q1<P.rp[r1+1] && !col_alive[P.ci[q1]]) q1++;
+            while(q2<P.rp[r2+1] && !col_alive[P.ci[q2]]) q2++;
+            bool e1=q1>=P.rp[r1+1], e2=q2>=P.rp[r2+1];
+            if(e1 || e2) return e1 && e2;
+            if(P.ci[q1]!=P.ci[q2]) return false;
+            double a=P.av[q1]/s1, b=P.av[q2]/s2;
+            if(std::fabs(a-b)>1e-12*(1+std::fabs(a))) return false;
+            q1++; q2++;
+        }
+    }
+
+    // ---- parallel columns ----
+    // a_k = s a_j on every live row and c_k = s c_j: x_j and x_k only occur
+    // as y = x_j + s x_k. Both continuous, or both integer with s = +-1.
+    bool parallel_columns(bool& changed){
+        std::vector<uint64_t> h(P.n,0);
+        std::vector<double> lead(P.n,0);
+        parallel_blocks(P.n,threads,[&](int j0,int j1){
+            for(int j=j0;j<j1;j++){
+                if(!col_alive[j]) continue;
+                uint64_t x=1469598103934665603ull;
+                double s=0; int len=0;
+                for(int q=P.cp[j];q<P.cp[j+1];q++){
+                    int r=P.ri[q];
+                    if(!row_alive[r]) continue;
+                    if(s==0) s=P.cv[q];
+                    x=mix(mix(x,(uint64_t)r),ratio_key(P.cv[q]/s));
+                    len++;
+                }
+                if(!len) continue;
+                h[j]=mix(mix(x,ratio_key(obj[j]/s)),is_int[j]); lead[j]=s;
+            }
+        });
+        std::vector<int> ord;
+        for(int j=0;j<P.n;j++) if(col_alive[j] && lead[j]!=0) ord.push_back(j);
+        std::sort(ord.begin(),ord.end(),[&](int a,int b){ return h[a]!=h[b] ? h[a]<h[b] : a<b; });
+        for(size_t i=0;i<ord.size();){
+            size_t e=i+1;
+            while(e<ord.size() && h[ord[e]]==h[ord[i]]) e++;
+            for(size_t a=i;a<e;a++){
+                int j=ord[a];
+                if(!col_alive[j]) continue;
+                for(size_t b=a+1;b<e;b++){
+                    int k=ord[b];
+                    if(!col_alive[k] || is_int[j]!=is_int[k]) continue;
+                    double s=lead[k]/lead[j];
+                    if(is_int[j] && std::fabs(std::fabs(s)-1)>1e-12) continue;
+                    if(is_int[j]) s=s>0?1:-1;
+                    if(!same_col(j,k,lead[j],lead[k])) continue;
+                    if(std::fabs(obj[k]-s*obj[j])>1e-12*(1+std::fabs(obj[k]))) continue;
+                    merge_cols(j,k,s);
+                    changed=true;
+                }
+            }
+            i=e;
+        }
+        return true;
+    }
+
+    bool same_col(int j, int k, double s1, double s2) const {
+        int q1=P.cp[j], q2=P.cp[k];
+        while(true){
+            while(q1<P.cp[j+1] && !row_alive[P.ri[q1]]) q1++;
+            while(q2<P.cp[k+1] && !row_alive[P.ri[q2]]) q2++;
+            bool e1=q1>=P.cp[j+1], e2=q2>=P.cp[k+1];
+            if(e1 || e2) return e1 && e2;
+            if(P.ri[q1]!=P.ri[q2]) return false;
+            double a=P.cv[q1]/s1, b=P.cv[q2]/s2;
+            if(std::fabs(a-b)>1e-12*(1+std::fabs(a))) return false;
+            q1++; q2++;
+        }
+    }
+
+    static double add_bound(double a, double b, bool lo){
+        if(lo) return (finite_lo(a) && finite_lo(b)) ? a+b : -MIP_INF;
+        return (finite_hi(a) && finite_hi(b)) ? a+b : MIP_INF;
+    }
+
+    void merge_cols(int j, int k, double s){
+        PostsolveOp o; o.kind=PostsolveOp::PARALLEL_COL;
+        o.j=j; o.k=k; o.v=s; o.lj=lb[j]; o.uj=ub[j]; o.lk=lb[k]; o.uk=ub[k];
+        R.ops.push_back(o);
+        // s x_k ranges over [s lk, s uk] (or reversed)
+        double klo = s>0 ? (finite_lo(lb[k])?s*lb[k]:-MIP_INF) : (finite_hi(ub[k])?s*ub[k]:-MIP_INF);
+        double khi = s>0 ? (finite_hi(ub[k])?s*ub[k]:MIP_INF)  : (finite_lo(lb[k])?s*lb[k]:MIP_INF);
+        lb[j]=add_bound(lb[j],klo,true);
+        ub[j]=add_bound(ub[j],khi,false);
+        remove_col(k);
+        st.parallel_cols++;
+    }
+
+    // ---- driver ----
+    bool run(){
+        std::vector<double> nlb, nub;
+        for(int round=0;round<opt.max_rounds;round++){
+            st.rounds++;
+            bool changed=false;
+            activities();
+            if(!row_checks(changed)) return false;
+            derive(nlb,nub);
+            for(int j=0;j<P.n;j++){
+                if(!col_alive[j]) continue;
+                // propagation works on the activities of this round;
+                // singleton rows may already have tightened further
+                double l=std::max(lb[j],nlb[j]), u=std::min(ub[j],nub[j]);
+                if(l>lb[j] || u<ub[j]){ st.tightened+=(l>lb[j])+(u<ub[j]); changed=true; }
+                lb[j]=l; ub[j]=u;
+            }
+            if(!col_checks(changed)) return false;
+            if(!changed){
+                if(opt.dup_rows && !duplicate_rows(changed)) return false;
+                if(opt.parallel_cols && !parallel_columns(changed)) return false;
+                if(!changed) break;
+            }
+        }
+        return true;
+    }
+
+    static char row_sense(double lo, double hi){
+        if(!finite_lo(lo)) return 'L';
+        if(!finite_hi(hi)) return 'G';
+        return lo==hi ? 'E' : 'R';
+    }
+
+    void build(){
+        MipProblem& M=R.model;
+        M=MipProblem();
+        std::vector<int> new_row(P.m,-1);
+        for(int r=0;r<P.m;r++) if(row_alive[r]){ new_row[r]=(int)R.row_orig.size(); R.row_orig.push_back(r); }
+        for(int j=0;j<P.n;j++) if(col_alive[j]) R.col_orig.push_back(j);
+        M.m=(int)R.row_orig.size();
+        M.n=(int)R.col_orig.size();
+        M.cp.assign(1,0);
+        for(int j:R.col_orig){
+            for(int q=P.cp[j];q<P.cp[j+1];q++){
+                int r=new_row[P.ri[q]];
+                if(r<0) continue;
+                M.ri.push_back(r); M.cv.push_back(P.cv[q]);
+            }
+            M.cp.push_back((int)M.ri.size());
+            M.obj.push_back(obj[j]); M.lb.push_back(lb[j]); M.ub.push_back(ub[j]);
+            M.is_int.push_back(is_int[j]);
+            M.cols.intern(P.col_name(j));
+        }
+        for(int r:R.row_orig){
+            M.rlo.push_back(rlo[r]); M.rhi.push_back(rhi[r]);
+            M.sense.push_back(row_sense(rlo[r],rhi[r]));
+            M.rows.intern(P.row_name(r));
+        }
+        M.obj_offset=offset;
+        M.obj_sense=P.obj_sense;
+        mip_build_csr(M);
+
+        R.removed_val.assign(P.n,0);
+        for(int j=0;j<P.n;j++) if(!col_alive[j]) R.removed_val[j]=lb[j];
+    }
+};
+
+} // namespace presolve_detail
+
+// Presolves P into R. Returns false and sets R.infeasible when a reduction
+// proves P infeasible.
+inline bool presolve(const MipView& P, Presolved& R, const PresolveOptions& opt=PresolveOptions()){
+    R=Presolved();
+    R.n_orig=P.n; R.m_orig=P.m;
+    presolve_detail::Work W(P,opt,R);
+    if(!W.run()){ R.infeasible=true; return false; }
+    W.build();
+    return true;
+}
@@ -0,0 +1,221 @@
+// prof.hpp  (header-only)
+//
+// Low-overhead scoped timers and counters.
+//
+//   PROF_SCOPE("pump.round");          // times the enclosing block
+//   PROF_COUNT("2opt.applied", k);     // adds k to a counter
+//
+// Every call site registers its name once (function-local static); after
+// that a scope costs two steady_clock reads and an append to a buffer owned
+// by the calling thread, and a counter is one add, so no lock is taken on
+// the hot path. Per thread the first PROF_EVENT_CAP events are kept for the
+// trace; the per-site totals are always exact.
+//
+// At the end of a run (threads joined):
+//   prof::print_summary(stdout);                 // calls, total, mean, max
+//   prof::write_chrome_trace("fp2opt.json");     // chrome://tracing, Perfetto
+//
+// Compile with -DFP_PROF=0 to remove the macros entirely; the report
+// functions then do nothing.
+//
+
+#pragma once
+
+#ifndef FP_PROF
+#define FP_PROF 1
+#endif
+
+#ifndef PROF_EVENT_CAP
+#define PROF_EVENT_CAP (1<<18)
+#endif
+
+#include <cstdint>
+#include <cstdio>
+
+#if FP_PROF
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace prof {
+
+namespace detail {
+
+struct Event { int site; int64_t t0, dur; };     // ns since epoch()
+struct Stat { int64_t calls=0, total=0, max=0; };
+
+struct ThreadBuf {
+    int tid=0;
+    std::vector<Event> ev;
+    std::vector<Stat> stat;         // by site
+    std::vector<int64_t> cnt;       // by site
+    int64_t dropped=0;
+};
+
+struct Registry {
+    std::mutex mu;
+    std::vector<const char*> names;
+    std::vector<bool> is_counter;
+    std::vector<std::unique_ptr<ThreadBuf>> bufs;
+};
+
+inline Registry& reg(){ static Registry r; return r; }
+
+inline int64_t now_ns(){
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline int64_t epoch(){ static const int64_t t=now_ns(); return t; }
+
+inline int site(const char* name, bool counter){
+    epoch();
+    Registry& r=reg();
+    std::lock_guard<std::mutex> g(r.mu);
+    // template instances and repeated names share one site
+    for(size_t i=0;i<r.names.size();i++)
+        if(r.is_counter[i]==counter && strcmp(r.names[i],name)==0) return (int)i;
+    r.names.push_back(name);
+    r.is_counter.push_back(counter);
+    return (int)r.names.size()-1;
+}
+
+inline ThreadBuf& buf(){
+    thread_local ThreadBuf* b=nullptr;
+    if(!b){
+        Registry& r=reg();
+        std::lock_guard<std::mutex> g(r.mu);
+        r.bufs.emplace_back(new ThreadBuf());
+        b=r.bufs.back().get();
+        b->tid=(int)r.bufs.size();
+        b->ev.reserve(1024);
+    }
+    return *b;
+}
+
+struct Scope {
+    int id;
+    int64_t t0;
+    explicit Scope(int s) : id(s), t0(now_ns()) {}
+    ~Scope(){
+        int64_t d=now_ns()-t0;
+        ThreadBuf& b=buf();
+        if((int)b.stat.size()<=id) b.stat.resize(id+1);
+        Stat& s=b.stat[id];
+        s.calls++; s.total+=d;
+        if(d>s.max) s.max=d;
+        if(b.ev.size()<(size_t)PROF_EVENT_CAP) b.ev.push_back({id,t0-epoch(),d});
+        else b.dropped++;
+    }
+};
+
+inline void count(int id, int64_t v){
+    ThreadBuf& b=buf();
+    if((int)b.cnt.size()<=id) b.cnt.resize(id+1,0);
+    b.cnt[id]+=v;
+}
+
+// JSON string body; names are literals, only quotes and backslashes matter
+inline void put_name(FILE* f, const char* s){
+    for(;*s;s++){
+        if(*s=='"' || *s=='\\') fputc('\\',f);
+        fputc(*s,f);
+    }
+}
+
+} // namespace detail
+
+// Per-site totals over all threads, in first-registration order.
+inline void print_summary(FILE* f){
+    using namespace detail;
+    Registry& r=reg();
+    std::lock_guard<std::mutex> g(r.mu);
+    double wall=(now_ns()-epoch())*1e-9;
+    size_t ns=r.names.size();
+    std::vector<Stat> st(ns);
+    std::vector<int64_t> cnt(ns,0);
+    int64_t dropped=0;
+    for(auto& b:r.bufs){
+        for(size_t i=0;i<b->stat.size();i++){
+            st[i].calls+=b->stat[i].calls;
+            st[i].total+=b->stat[i].total;
+            st[i].max=std::max(st[i].max,b->stat[i].max);
+        }
+        for(size_t i=0;i<b->cnt.size();i++) cnt[i]+=b->cnt[i];
+        dropped+=b->dropped;
+    }
+    fprintf(f,"\n%-24s %10s %12s %11s %11s %7s\n","phase","calls","total ms","mean us","max us","% wall");
+    for(size_t i=0;i<ns;i++){
+        if(r.is_counter[i] || !st[i].calls) continue;
+        fprintf(f,"%-24s %10lld %12.3f %11.2f %11.2f %6.1f%%\n",r.names[i],(long long)st[i].calls,
+                st[i].total*1e-6,st[i].total*1e-3/st[i].calls,st[i].max*1e-3,
+                wall>0 ? 100.0*st[i].total*1e-9/wall : 0.0);
+    }
+    bool any=false;
+    for(size_t i=0;i<ns;i++){
+        if(!r.is_counter[i]) continue;
+        if(!any){ fprintf(f,"%-24s %10s\n","counter","value"); any=true; }
+        fprintf(f,"%-24s %10lld\n",r.names[i],(long long)cnt[i]);
+    }
+    fprintf(f,"wall %.3f s, %zu threads%s\n",wall,r.bufs.size(),dropped?", trace truncated":"");
+}
+
+// Complete ("X") events per thread, counter totals as one "C" event each.
+inline bool write_chrome_trace(const char* path){
+    using namespace detail;
+    Registry& r=reg();
+    std::lock_guard<std::mutex> g(r.mu);
+    FILE* f=fopen(path,"w");
+    if(!f) return false;
+    setvbuf(f,nullptr,_IOFBF,1<<20);
+    fprintf(f,"{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first=true;
+    std::vector<int64_t> cnt(r.names.size(),0);
+    for(auto& b:r.bufs){
+        fprintf(f,"%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}",
+                first?"":",\n",b->tid,b->tid);
+        first=false;
+        for(const Event& e:b->ev){
+            fprintf(f,",\n{\"name\":\"");
+            put_name(f,r.names[e.site]);
+            fprintf(f,"\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",b->tid,e.t0*1e-3,e.dur*1e-3);
+        }
+        for(size_t i=0;i<b->cnt.size();i++) cnt[i]+=b->cnt[i];
+    }
+    double end=(now_ns()-epoch())*1e-3;
+    for(size_t i=0;i<r.names.size();i++){
+        if(!r.is_counter[i]) continue;
+        fprintf(f,",\n{\"name\":\"");
+        put_name(f,r.names[i]);
+        fprintf(f,"\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"value\":%lld}}",end,(long long)cnt[i]);
+    }
+    fprintf(f,"\n]}\n");
+    return fclose(f)==0;
+}
+
+} // namespace prof
+
+#define PROF_CAT2(a,b) a##b
+#define PROF_CAT(a,b) PROF_CAT2(a,b)
+#define PROF_SCOPE(name) \
+    static const int PROF_CAT(prof_site_,__LINE__)=prof::detail::site(name,false); \
+    prof::detail::Scope PROF_CAT(prof_scope_,__LINE__)(PROF_CAT(prof_site_,__LINE__))
+#define PROF_COUNT(name,v) do { \
+    static const int prof_site_=prof::detail::site(name,true); \
+    prof::detail::count(prof_site_,(int64_t)(v)); } while(0)
+
+#else
+
+namespace prof {
+inline void print_summary(FILE*){}
+inline bool write_chrome_trace(const char*){ return true; }
+}
+
+#define PROF_SCOPE(name) do {} while(0)
+#define PROF_COUNT(name,v) do {} while(0)
+
+#endif
@@ -0,0 +1,200 @@
+// pump_cycle.hpp  (header-only)
+//
+// Rounding state for the feasibility pump with cheap cycle detection.
+// The integer part of the rounded point is identified by a 64-bit Zobrist
+// hash  H = XOR_j z(j, xr_j)  over integer columns; a change of xr_j costs
+// one XOR pair, so re-rounding only touches the columns that flip.
+//
+// Cycles are broken as in the original pump (Fischetti, Glover, Lodi):
+//   short cycle  (same rounding as the last iteration): flip the TT
+//                integer columns with the largest |xlp_j - xr_j|,
+//                TT uniform in [T/2, 3T/2]
+//   long cycle   (hash seen before): restart, flipping every integer
+//                column with |xlp_j - xr_j| + max(rho_j, 0) > 0.5,
+//                rho_j uniform in [-0.3, -0.3 + strength]  (default 0.7)
+// A flip moves xr_j to the other integer next to xlp_j, within bounds.
+// Integer columns round up when their fractional part is >= threshold.
+// With use_propagation() the rounding is fix-and-propagate
+// (fix_propagate.hpp) instead of independent per column, or plain rounding
+// when that violates fewer rows by the pump's own check (feas_check.hpp).
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include "feas_check.hpp"
+#include "fix_propagate.hpp"
+#include "mip_problem.hpp"
+
+struct ZobristHash {
+    uint64_t seed=0x9e3779b97f4a7c15ull;
+    uint64_t h=0;
+
+    static uint64_t mix(uint64_t z){
+        z+=0x9e3779b97f4a7c15ull;
+        z=(z^(z>>30))*0xbf58476d1ce4e5b9ull;
+        z=(z^(z>>27))*0x94d049bb133111ebull;
+        return z^(z>>31);
+    }
+    // contribution of column j at value v (v+0.0 folds -0.0 into 0.0)
+    uint64_t term(int j, double v) const {
+        v+=0.0;
+        uint64_t b; memcpy(&b,&v,8);
+        return mix(seed ^ mix(b) ^ (uint64_t)(uint32_t)j);
+    }
+    void change(int j, double from, double to){ if(from!=to) h^=term(j,from)^term(j,to); }
+};
+
+struct PumpRounding {
+    const MipView* P=nullptr;
+    std::vector<double> xr;
+    ZobristHash z;
+    std::unordered_set<uint64_t> seen;
+    uint64_t last=0;
+    std::mt19937_64 rng;
+
+    double threshold=0.5;           // rounding threshold on the fraction
+    double strength=1.0;            // width of the restart rho interval
+
+    int flips=0, restarts=0;        // perturbation statistics
+
+    bool propagate=false;
+    bool clean=false;               // last round() propagated without a conflict
+    FixPropagate fixprop;
+    std::vector<double> xf, xp;
+    // the pump's own feasibility check, to pick between the roundings
+    const spmv::Matrix* check=nullptr;
+    int check_threads=0;
+    ViolationReport vr;
+
+    void init(const MipView& p, uint64_t seed=1){
+        P=&p;
+        xr.assign(p.n,0);
+        for(int j=0;j<p.n;j++) xr[j]=clamp(j,0);
+        z.seed=ZobristHash::mix(seed);
+        z.h=0;
+        for(int j=0;j<p.n;j++) if(p.is_int[j]) z.h^=z.term(j,xr[j]);
+        seen.clear();
+        last=~z.h;
+        rng.seed(seed);
+        flips=restarts=0;
+        propagate=false;
+    }
+
+    // A: built on the model, for check_violation at the pump's 1e-8
+    void use_propagation(FixPropagate::Order order, int max_backtracks, const spmv::Matrix& A,
+                         int threads=0){
+        propagate=true;
+        check=&A;
+        check_threads=threads;
+        fixprop.order=order;
+        fixprop.max_backtracks=max_backtracks;
+        fixprop.init(*P);
+    }
+
+    double clamp(int j, double v) const {
+        if(v<P->lb[j]) v=P->lb[j];
+        if(v>P->ub[j]) v=P->ub[j];
+        return v;
+    }
+
+    void set(int j, double v){
+        if(P->is_int[j]) z.change(j,xr[j],v);
+        xr[j]=v;
+    }
+
+    // integer columns: floor(x) + (frac(x) >= threshold)
+    double round_int(double x) const {
+        double f=std::floor(x);
+        return x-f>=threshold ? f+1 : f;
+    }
+
+    double plain(int j, double x) const {
+        return clamp(j, P->is_int[j] ? round_int(x) : x);
+    }
+
+    int violated_rows(const std::vector<double>& x){
+        check_violation(*check,x.data(),vr,1e-8,false,check_threads);
+        return (int)vr.violated.size();
+    }
+
+    // xr = clamp(rounding of xlp) on integer columns, continuous columns
+    // keep their LP value; only integer columns that change touch the hash.
+    // With propagation, plain rounding is kept instead when it violates
+    // fewer rows (on mixed models the propagated integer part can fit the
+    // continuous LP values worse); clean is then false.
+    void round(const double* xlp){
+        if(propagate){
+            clean=fixprop.round(xlp,threshold,xf);
+            int vf=violated_rows(xf);
+            if(vf>0){
+                xp.resize(P->n);
+                for(int j=0;j<P->n;j++) xp[j]=plain(j,xlp[j]);
+                if(violated_rows(xp)<vf){ xf.swap(xp); clean=false; }
+            }
+            for(int j=0;j<P->n;j++) if(xf[j]!=xr[j]) set(j,xf[j]);
+            return;
+        }
+        for(int j=0;j<P->n;j++){
+            double v=plain(j,xlp[j]);
+            if(v!=xr[j]) set(j,v);
+        }
+    }
+
+    // integer column j to the other integer next to xlp_j; false if blocked
+    bool flip(int j, const double* xlp){
+        double v=clamp(j, xlp[j]>=xr[j] ? xr[j]+1 : xr[j]-1);
+        if(v==xr[j]) return false;
+        set(j,v);
+        return true;
+    }
+
+    // Applies the cycle rules to the current rounding and records its hash.
+    // Returns 0 for a new point, 1 after a flip, 2 after a restart.
+    int resolve_cycle(const double* xlp, int T){
+        int what=0;
+        if(z.h==last){
+            flip_top(xlp,T);
+            what=1;
+        }
+        for(int tries=0;seen.count(z.h) && tries<8;tries++){
+            restart(xlp);
+            what=2;
+        }
+        seen.insert(z.h);
+        last=z.h;
+        return what;
+    }
+
+private:
+    void flip_top(const double* xlp, int T){
+        std::vector<std::pair<double,int>> cand;
+        for(int j=0;j<P->n;j++){
+            if(!P->is_int[j]) continue;
+            double d=std::fabs(xlp[j]-xr[j]);
+            if(d>0) cand.push_back({-d,j});
+        }
+        int tt=T/2+(int)(rng()%(uint64_t)(T+1));
+        if(tt<1) tt=1;
+        if(tt>(int)cand.size()) tt=(int)cand.size();
+        std::partial_sort(cand.begin(),cand.begin()+tt,cand.end());
+        for(int k=0;k<tt;k++) flips+=flip(cand[k].second,xlp);
+    }
+
+    void restart(const double* xlp){
+        std::uniform_real_distribution<double> rho(-0.3,-0.3+strength);
+        for(int j=0;j<P->n;j++){
+            if(!P->is_int[j]) continue;
+            double r=rho(rng);
+            if(std::fabs(xlp[j]-xr[j])+std::max(r,0.0)>0.5) flip(j,xlp);
+        }
+        restarts++;
+    }
+};
@@ -0,0 +1,141 @@
+// pump_lp.hpp  (header-only, needs Osi/Clp)
+//
+// Projection LP of the feasibility pump: min Delta(x, xr) over the LP
+// relaxation, with the L1 distance taken over integer columns only.
+//   binary j  (ub - lb == 1)   x_j - lb_j  or  ub_j - x_j,  a sign flip of c_j
+//   general j                  auxiliary d_j >= |x_j - xr_j| with rows
+//                                d_j - x_j >= -xr_j,   d_j + x_j >= xr_j
+//   continuous / fixed j       not in the objective
+// Between iterations only columns whose rounding changed are touched
+// (one objective coefficient, or two row lower bounds), and the LP is
+// re-solved with primal simplex from the previous basis: an objective
+// change keeps the basis primal feasible.
+// Once there is an incumbent, set_cutoff adds the row obj.x <= bound (the
+// minimised cost of P, no offset) and afterwards only tightens it, so the
+// projections stay among points that could improve on it.
+//
+//   ProjectionLP proj(s, P);          // s: loaded with load_osi, solved
+//   proj.set_cutoff(bound);           // optional, any time
+//   while(...) proj.solve(xr, xlp);   // false: LP infeasible
+//
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "OsiClpSolverInterface.hpp"
+#include "mip_problem.hpp"
+
+class ProjectionLP {
+public:
+    ProjectionLP(OsiClpSolverInterface& s, const MipView& P) : s_(s), P_(P) { build(); }
+
+    // Solves the distance LP for rounding xr; xlp gets the first n columns.
+    bool solve(const std::vector<double>& xr, std::vector<double>& xlp){
+        for(int j=0;j<P_.n;j++){
+            if(kind_[j]==NONE) continue;
+            if(!first_ && xr[j]==prev_[j]) continue;
+            update(j,xr[j]);
+            changed++;
+        }
+        prev_=xr;
+        first_=false;
+
+        s_.resolve();
+        lp_iters+=s_.getIterationCount();
+        if(s_.isProvenPrimalInfeasible()) return false;
+        const double* x=s_.getColSolution();
+        xlp.assign(x,x+P_.n);
+        return true;
+    }
+
+    // false when P has no objective, so no point can beat the incumbent
+    bool set_cutoff(double bound){
+        if(cut_row_<0){
+            std::vector<int> col;
+            std::vector<double> el;
+            for(int j=0;j<P_.n;j++) if(P_.obj[j]!=0){ col.push_back(j); el.push_back(P_.obj[j]); }
+            if(col.empty()) return false;
+            cut_row_=s_.getNumRows();
+            CoinBigIndex rs[2]={0,(CoinBigIndex)col.size()};
+            double lo=-s_.getInfinity();
+            s_.addRows(1,rs,col.data(),el.data(),&lo,&bound);
+        } else if(bound<cut_) s_.setRowUpper(cut_row_,bound);
+        cut_=std::min(cut_,bound);
+        return true;
+    }
+
+    int binaries() const { return nbin_; }
+    int generals() const { return (int)gen_.size(); }
+
+    long long changed=0;            // coefficient / row updates so far
+    long long lp_iters=0;           // simplex iterations over all solves
+
+private:
+    enum Kind : unsigned char { NONE, BIN, GEN };
+
+    void build(){
+        int n=P_.n;
+        kind_.assign(n,NONE);
+        aux_.assign(n,-1);
+        nbin_=0;
+        for(int j=0;j<n;j++){
+            if(!P_.is_int[j] || P_.lb[j]>=P_.ub[j]) continue;
+            if(P_.ub[j]-P_.lb[j]==1){ kind_[j]=BIN; nbin_++; }
+            else { kind_[j]=GEN; aux_[j]=(int)gen_.size(); gen_.push_back(j); }
+        }
+
+        s_.setObjSense(1.0);
+        s_.setDblParam(OsiObjOffset,0.0);
+        for(int j=0;j<n;j++) s_.setObjCoeff(j,0.0);
+
+        int g=(int)gen_.size();
+        if(g){
+            double inf=s_.getInfinity();
+            std::vector<CoinBigIndex> cs(g+1,0);
+            std::vector<double> lo(g,0.0), hi(g,inf), c(g,1.0);
+            s_.addCols(g,cs.data(),nullptr,nullptr,lo.data(),hi.data(),c.data());
+
+            // lower bounds are set from xr on the first solve
+            row0_=s_.getNumRows();
+            std::vector<CoinBigIndex> rs(2*g+1);
+            std::vector<int> col(4*g);
+            std::vector<double> el(4*g), rlo(2*g,-inf), rhi(2*g,inf);
+            for(int k=0;k<g;k++){
+                int j=gen_[k];
+                for(int t=0;t<2;t++){
+                    int r=2*k+t;
+                    rs[r]=2*r;
+                    col[2*r]=n+k;   el[2*r]=1.0;
+                    col[2*r+1]=j;   el[2*r+1]=t?1.0:-1.0;
+                }
+            }
+            rs[2*g]=4*g;
+            s_.addRows(2*g,rs.data(),col.data(),el.data(),rlo.data(),rhi.data());
+        }
+
+        s_.setHintParam(OsiDoDualInResolve,false,OsiHintDo);
+        s_.setHintParam(OsiDoPresolveInResolve,false,OsiHintDo);
+        first_=true;
+    }
+
+    void update(int j, double v){
+        if(kind_[j]==BIN){
+            s_.setObjCoeff(j, v<=P_.lb[j] ? 1.0 : -1.0);
+        } else {
+            int r=row0_+2*aux_[j];
+            s_.setRowLower(r,-v);
+            s_.setRowLower(r+1,v);
+        }
+    }
+
+    OsiClpSolverInterface& s_;
+    const MipView& P_;
+    std::vector<unsigned char> kind_;
+    std::vector<int> aux_, gen_;
+    std::vector<double> prev_;
+    int nbin_=0, row0_=0, cut_row_=-1;
+    double cut_=MIP_INF;
+    bool first_=true;
+};
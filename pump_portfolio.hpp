@@ -0,0 +1,167 @@
+// pump_portfolio.hpp  (header-only, needs Osi/Clp, link with -lpthread)
+//
+// Feasibility pump workers, run alone or as a parallel portfolio. Every
+// worker owns a copy of the root LP (warm basis included), its own
+// PumpRounding and ProjectionLP, and a PumpConfig (seed, rounding
+// threshold, flip count, restart strength), so the trajectories diverge.
+//
+// Workers share one SharedIncumbent (incumbent.hpp). Its objective is an atomic cutoff
+// read without locking. Once there is one (from FJ, the candidate roundings
+// or another worker), every projection LP gets the row
+// obj.x <= cutoff - delta, tightened as the cutoff drops, so the pump keeps
+// looking for better points; roundings that cannot beat the cutoff are
+// not checked, and a worker stops when its LP becomes infeasible or after
+// `stall` iterations without the cutoff dropping (so FJ's incumbent leaves
+// time for the stages after the pump). A feasible rounding is only
+// published when it improves.
+//
+//   SharedIncumbent inc(on_improve);
+//   run_pump_portfolio(P, s, xlp, portfolio_configs(N, seed, flip), inc, deadline);
+//
+
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "OsiClpSolverInterface.hpp"
+#include "feas_check.hpp"
+#include "incumbent.hpp"
+#include "mip_problem.hpp"
+#include "prof.hpp"
+#include "pump_cycle.hpp"
+#include "pump_lp.hpp"
+
+struct PumpConfig {
+    uint64_t seed=1;
+    double threshold=0.5;           // integer columns round up at frac >= threshold
+    int flip=20;                    // T for short-cycle flips
+    double strength=1.0;            // restart rho in [-0.3, -0.3 + strength]
+    int check_threads=0;            // feasibility check threads (0 = by size)
+    bool propagate=true;            // fix-and-propagate rounding
+    FixPropagate::Order order=FixPropagate::LOCKS;
+    int backtracks=64;
+    double cutoff_delta=1e-6;       // projection LP: obj.x <= cutoff - delta (1 + |cutoff|)
+    int stall=200;                  // iterations under an unchanged cutoff before stopping
+};
+
+struct PumpStats {
+    int iters=0, flips=0, restarts=0;
+    int clean=0;                    // roundings propagated without a conflict
+    int found_iter=0;               // iteration of the published point (1 = no projection LP)
+    long long lp_iters=0;
+    bool found=false;               // published an improving feasible point
+};
+
+// One pump from the root LP solution xlp0; lp is a solved copy of the root
+// LP and is turned into the projection LP.
+inline PumpStats run_pump(const MipView& P, OsiClpSolverInterface& lp,
+                          const std::vector<double>& xlp0, const PumpConfig& cfg,
+                          SharedIncumbent& inc, std::chrono::steady_clock::time_point deadline){
+    PROF_SCOPE("pump.worker");
+    PumpStats st;
+    PumpRounding pr;
+    pr.init(P,cfg.seed);
+    pr.threshold=cfg.threshold;
+    pr.strength=cfg.strength;
+    ProjectionLP proj(lp,P);
+    std::vector<double> xlp=xlp0;
+    ViolationReport vr;
+    spmv::Matrix A;
+    A.build(P);
+    if(cfg.propagate) pr.use_propagation(cfg.order,cfg.backtracks,A,cfg.check_threads);
+    double last_cut=MIP_INF;
+    int since=0;
+
+    while(std::chrono::steady_clock::now()<deadline){
+        st.iters++;
+        PROF_COUNT("pump.iters",1);
+        {
+            PROF_SCOPE("pump.round");
+            pr.round(xlp.data());
+        }
+        int cyc;
+        {
+            PROF_SCOPE("pump.cycle");           // hashing, flips, restarts
+            cyc=pr.resolve_cycle(xlp.data(),cfg.flip);
+        }
+        if(cyc) PROF_COUNT("pump.cycles",1);
+        st.clean+=pr.clean;
+        const std::vector<double>& xr=pr.xr;
+
+        double o=0;
+        for(int j=0;j<P.n;j++) o+=P.obj[j]*xr[j];
+        if(o<inc.cutoff()){
+            {
+                PROF_SCOPE("pump.check");
+                check_violation(A,xr.data(),vr,1e-8,false,cfg.check_threads);
+            }
+            if(vr.feasible() && inc.offer(xr,o)){
+                st.found=true;
+                st.found_iter=st.iters;
+                break;
+            }
+        }
+        if(inc.has()){
+            double c=inc.cutoff();
+            if(c<last_cut){ last_cut=c; since=0; }
+            else if(++since>=cfg.stall) break;
+            if(!proj.set_cutoff(c-cfg.cutoff_delta*(1+std::fabs(c)))) break;
+        }
+        PROF_SCOPE("pump.lp");
+        if(!proj.solve(xr,xlp)) break;
+    }
+    st.flips=pr.flips;
+    st.restarts=pr.restarts;
+    st.lp_iters=proj.lp_iters;
+    return st;
+}
+
+// N configurations: worker 0 is the plain pump (threshold 0.5, flip T);
+// the others draw threshold, flip count and restart strength from seed
+// and cycle through the fix-and-propagate orders.
+inline std::vector<PumpConfig> portfolio_configs(int N, uint64_t seed, int flip){
+    std::vector<PumpConfig> c(N<1?1:N);
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> thr(0.3,0.7), str(0.6,1.4), fl(0.5,2.0);
+    for(int k=0;k<(int)c.size();k++){
+        c[k].seed=seed+k;
+        c[k].flip=flip;
+        if(k==0) continue;
+        c[k].order=(FixPropagate::Order)((c[0].order+k)%3);
+        c[k].threshold=thr(rng);
+        c[k].strength=str(rng);
+        c[k].flip=std::max(1,(int)(flip*fl(rng)));
+    }
+    if(c.size()>1) for(auto& x:c) x.check_threads=1;
+    return c;
+}
+
+// Runs one worker per config; worker 0 uses s itself, the others copies
+// made before any thread starts.
+inline std::vector<PumpStats> run_pump_portfolio(const MipView& P, OsiClpSolverInterface& s,
+                                                 const std::vector<double>& xlp0,
+                                                 const std::vector<PumpConfig>& cfg,
+                                                 SharedIncumbent& inc,
+                                                 std::chrono::steady_clock::time_point deadline){
+    int N=(int)cfg.size();
+    std::vector<PumpStats> st(N);
+    std::vector<std::unique_ptr<OsiClpSolverInterface>> lp;
+    for(int k=1;k<N;k++){
+        lp.emplace_back(new OsiClpSolverInterface(s));
+        lp.back()->messageHandler()->setLogLevel(0);
+    }
+    std::vector<std::thread> th;
+    for(int k=1;k<N;k++)
+        th.emplace_back([&,k]{ st[k]=run_pump(P,*lp[k-1],xlp0,cfg[k],inc,deadline); });
+    st[0]=run_pump(P,s,xlp0,cfg[0],inc,deadline);
+    for(auto& t:th) t.join();
+    return st;
+}
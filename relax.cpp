@@ -5,6 +5,8 @@
 #include <iomanip> // For std::setw and std::setfill
 #include "coin/CbcModel.hpp"
 #include "coin/OsiClpSolverInterface.hpp"
+#include "mip_cache.hpp"
+#include "mip_osi.hpp"
 
 namespace fs = std::filesystem;
 
@@ -30,26 +32,24 @@ int main() {
         std::string inFile  = inPath.str();
         std::string outBase = outPath.str();
 
-        if (!fs::exists(inFile)) {
-            std::cerr << "Skipping: " << inFile << " (not found)" << std::endl;
+        // Uses the unzip_all cache when present; .mps.gz is streamed otherwise
+        if (!fs::exists(inFile) && !fs::exists(mip_cache_path(inFile))) inFile += ".gz";
+        if (!fs::exists(inFile) && !fs::exists(mip_cache_path(inFile))) {
+            std::cerr << "Skipping: " << inPath.str() << " (not found)" << std::endl;
             continue;
         }
 
-        OsiClpSolverInterface solver;
-
         // Load MPS
-        if (solver.readMps(inFile.c_str()) != 0) {
-            std::cerr << "Error reading: " << inFile << std::endl;
+        MipInstance inst;
+        std::string err;
+        if (!inst.open(inFile, &err)) {
+            std::cerr << "Error reading: " << inFile << " (" << err << ")" << std::endl;
             continue;
         }
 
-        // RELAXATION FIX: Use setContinuous instead of setInteger
-        int numCols = solver.getNumCols();
-        for (int col = 0; col < numCols; col++) {
-            if (solver.isInteger(col)) {
-                solver.setContinuous(col); 
-            }
-        }
+        // RELAXATION: load without integer markers, keep original names
+        OsiClpSolverInterface solver;
+        load_osi(solver, inst.view, false, true);
 
         // Write model (adds .mps and possibly .gz automatically)
         solver.writeMps(outBase.c_str());
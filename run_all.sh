@@ -23,6 +23,10 @@ for mps_file in test_set/relaxedInstances/*.mps; do
     log_path="$LOGS_DIR/${base_name}.log"
     
     echo "Processing: $base_name"
+
+    # Use the binary cache from unzip_all when it exists (no MPS parse)
+    cache_file="test_set/instances/instance_${base_name#relaxed_}.mipc"
+    [ -f "$cache_file" ] && mps_file="$cache_file"
     
     # Run the solver:
     # '>' redirects standard output to the log file
@@ -0,0 +1,215 @@
+// sol_reader.hpp  (header-only)
+//
+// Loads a stored (relaxed) solution into a dense x for a model. The file
+// is mapped and parsed in place with std::from_chars; three formats are
+// recognised from their first bytes:
+//
+//   .msol     sparse binary (mip_sol.h), e.g. from cuopt_pdlp / fp2opt
+//   cuOpt     "Objective = v" then "x<k> = v" with k 1-based
+//             (results_pdlp_1e-06/, src/l40s_pdlp_sols_1e-6/)
+//   Gurobi    "Objective value: v" ... "Variable values:" then "<name> v"
+//             with MPS column names (test_set/relaxSol/)
+//   fp2opt    "obj: v" then "x<k> v" with k 0-based (sol_writer.hpp text)
+//
+// Columns not listed are 0. Names are matched against the model in file
+// order first and through a hash index only on a miss.
+//
+//   LoadedSol S; std::string err;
+//   if(!load_solution("test_set/relaxSol/sol01.txt", P, S, &err)) ...
+//
+
+#pragma once
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mip_problem.hpp"
+#include "mip_sol.h"
+
+enum class SolFormat { UNKNOWN, MSOL, CUOPT, GUROBI, FP2OPT };
+
+struct LoadedSol {
+    std::vector<double> x;
+    double obj=NAN;                 // objective stored in the file, if any
+    SolFormat format=SolFormat::UNKNOWN;
+    int64_t entries=0;              // values read from the file
+    int64_t unmatched=0;            // names / indices not in the model
+};
+
+namespace sol_detail {
+
+inline bool starts_with(std::string_view s, std::string_view p){
+    return s.size()>=p.size() && s.compare(0,p.size(),p)==0;
+}
+
+inline std::string_view trim(std::string_view s){
+    while(!s.empty() && (s.front()==' ' || s.front()=='\t')) s.remove_prefix(1);
+    while(!s.empty() && (s.back()==' ' || s.back()=='\t' || s.back()=='\r')) s.remove_suffix(1);
+    return s;
+}
+
+inline bool parse_double(std::string_view s, double& v){
+    s=trim(s);
+    if(!s.empty() && s.front()=='+') s.remove_prefix(1);
+    auto r=std::from_chars(s.data(),s.data()+s.size(),v);
+    return r.ec==std::errc() && r.ptr==s.data()+s.size();
+}
+
+// column lookup by name: next-in-order guess, then a lazily built index
+struct ColIndex {
+    const MipView& P;
+    std::unordered_map<std::string_view,int> map;
+    int next=0;
+
+    explicit ColIndex(const MipView& p) : P(p) {}
+
+    int find(std::string_view name){
+        if(next<P.n && P.col_name(next)==name) return next++;
+        if(map.empty() && P.n){
+            map.reserve((size_t)P.n*2);
+            for(int j=0;j<P.n;j++) map.emplace(P.col_name(j),j);
+        }
+        auto it=map.find(name);
+        if(it==map.end()) return -1;
+        next=it->second+1;
+        return it->second;
+    }
+};
+
+inline bool fail(std::string* err, const std::string& msg){
+    if(err) *err=msg;
+    return false;
+}
+
+inline bool load_msol(const char* b, size_t len, const MipView& P, LoadedSol& S, std::string* err){
+    MipSolHeader h;
+    if(len<sizeof(h)) return fail(err,"truncated .msol header");
+    memcpy(&h,b,sizeof(h));
+    if(h.version!=MSOL_VERSION || h.header_size!=sizeof(MipSolHeader))
+        return fail(err,"unsupported .msol version");
+    if(h.n!=P.n) return fail(err,"solution has "+std::to_string(h.n)+" columns, model has "+std::to_string(P.n));
+    size_t need=sizeof(h)+(size_t)msol_idx_bytes(h.nnz)+(size_t)h.nnz*sizeof(double);
+    if(h.nnz<0 || len<need) return fail(err,"truncated .msol data");
+    const char* idx=b+sizeof(h);
+    const char* val=idx+msol_idx_bytes(h.nnz);
+    for(int64_t k=0;k<h.nnz;k++){
+        int32_t j; double v;
+        memcpy(&j,idx+k*sizeof(int32_t),sizeof(j));
+        memcpy(&v,val+k*sizeof(double),sizeof(v));
+        if(j<0 || j>=P.n){ S.unmatched++; continue; }
+        S.x[j]=v;
+    }
+    S.entries=h.nnz;
+    S.obj=h.obj;
+    S.format=SolFormat::MSOL;
+    return true;
+}
+
+// Text formats, one pass over the lines.
+inline bool load_text(const char* b, size_t len, const MipView& P, LoadedSol& S, std::string* err){
+    const char* p=b; const char* e=b+len;
+    ColIndex names(P);
+    bool values=false;
+    int64_t lineno=0;
+    while(p<e){
+        const char* nl=(const char*)memchr(p,'\n',(size_t)(e-p));
+        if(!nl) nl=e;
+        std::string_view ln=trim(std::string_view(p,(size_t)(nl-p)));
+        p=nl+1;
+        lineno++;
+        if(ln.empty()) continue;
+
+        if(!values){
+            if(starts_with(ln,"Objective = ")){
+                S.format=SolFormat::CUOPT;
+                parse_double(ln.substr(12),S.obj);
+                values=true;
+                continue;
+            }
+            if(starts_with(ln,"obj: ")){
+                S.format=SolFormat::FP2OPT;
+                parse_double(ln.substr(5),S.obj);
+                values=true;
+                continue;
+            }
+            if(starts_with(ln,"Objective value:")){
+                S.format=SolFormat::GUROBI;
+                parse_double(ln.substr(16),S.obj);
+                continue;
+            }
+            if(starts_with(ln,"Variable values:")){
+                S.format=SolFormat::GUROBI;
+                values=true;
+                continue;
+            }
+            // other "Key: value" header lines (Status:, Solve time ...)
+            if(S.format==SolFormat::GUROBI || ln.find(':')!=std::string_view::npos){
+                S.format=SolFormat::GUROBI;
+                continue;
+            }
+            values=true;                                    // no header at all
+        }
+
+        // "<name> <v>" or "<name> = <v>"
+        size_t sp=ln.find_first_of(" \t");
+        if(sp==std::string_view::npos) return fail(err,"line "+std::to_string(lineno)+": no value");
+        std::string_view name=ln.substr(0,sp), rest=trim(ln.substr(sp));
+        if(!rest.empty() && rest.front()=='=') rest.remove_prefix(1);
+        double v;
+        if(!parse_double(rest,v)) return fail(err,"line "+std::to_string(lineno)+": bad value");
+
+        int j=-1;
+        bool numbered=S.format==SolFormat::CUOPT || S.format==SolFormat::FP2OPT;
+        if(numbered && name.size()>1 && name[0]=='x'){
+            long long k;
+            auto r=std::from_chars(name.data()+1,name.data()+name.size(),k);
+            if(r.ec==std::errc() && r.ptr==name.data()+name.size()){
+                if(S.format==SolFormat::CUOPT) k--;
+                j=(k>=0 && k<P.n) ? (int)k : -1;
+            }
+            else j=names.find(name);
+        } else {
+            j=names.find(name);
+        }
+        S.entries++;
+        if(j<0){ S.unmatched++; continue; }
+        S.x[j]=v;
+    }
+    if(S.format==SolFormat::UNKNOWN) S.format=SolFormat::GUROBI;
+    return true;
+}
+
+} // namespace sol_detail
+
+inline bool load_solution(const std::string& file, const MipView& P, LoadedSol& S, std::string* err=nullptr){
+    S=LoadedSol();
+    S.x.assign(P.n,0.0);
+
+    int fd=open(file.c_str(),O_RDONLY);
+    if(fd<0) return sol_detail::fail(err,"cannot open "+file);
+    struct stat st;
+    if(fstat(fd,&st)!=0){ close(fd); return sol_detail::fail(err,"cannot stat "+file); }
+    size_t len=(size_t)st.st_size;
+    if(!len){ close(fd); return sol_detail::fail(err,"empty file "+file); }
+    void* mem=mmap(nullptr,len,PROT_READ,MAP_PRIVATE,fd,0);
+    close(fd);
+    if(mem==MAP_FAILED) return sol_detail::fail(err,"mmap failed for "+file);
+    madvise(mem,len,MADV_SEQUENTIAL);
+    const char* b=(const char*)mem;
+
+    bool ok = len>=8 && memcmp(b,MSOL_MAGIC,8)==0
+            ? sol_detail::load_msol(b,len,P,S,err)
+            : sol_detail::load_text(b,len,P,S,err);
+    munmap(mem,len);
+    return ok;
+}
@@ -0,0 +1,159 @@
+// sol_writer.hpp  (header-only, link with -lpthread)
+//
+// Asynchronous incumbent output. submit() only gathers the nonzeros of x
+// into a job and queues it; a background thread writes the files
+//     dir/incumbent_<id>.msol   sparse binary (mip_sol.h)
+//     dir/incumbent_<id>.sol    text: "obj: v" then "x<i> v" per column
+// so the search thread never waits on the file system. The queue is
+// bounded: when it is full the oldest pending incumbent is dropped (a
+// newer, better one is queued behind it), counted in dropped(). The
+// destructor writes everything still queued.
+//
+//   SolWriter out("solFiles/fp2Opt/instance1", SolWriter::BIN);
+//   out.submit(id, x, obj, "2opt");
+//
+
+#pragma once
+
+#include <charconv>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mip_sol.h"
+#include "prof.hpp"
+
+class SolWriter {
+public:
+    enum Format { BIN=1, TEXT=2, BOTH=3 };
+
+    explicit SolWriter(std::string dir, int fmt=BIN, size_t capacity=16)
+        : dir_(std::move(dir)), fmt_(fmt), cap_(capacity<1?1:capacity) {
+        std::error_code ec;
+        std::filesystem::create_directories(dir_,ec);
+        th_=std::thread(&SolWriter::loop,this);
+    }
+
+    ~SolWriter(){
+        {
+            std::lock_guard<std::mutex> g(mu_);
+            stop_=true;
+        }
+        cv_.notify_one();
+        th_.join();
+    }
+
+    SolWriter(const SolWriter&) = delete;
+    SolWriter& operator=(const SolWriter&) = delete;
+
+    void submit(int id, const std::vector<double>& x, double obj, const char* source){
+        PROF_SCOPE("sol.submit");
+        Job j;
+        j.id=id; j.n=(int64_t)x.size(); j.obj=obj; j.ts=msol_now();
+        snprintf(j.source,sizeof(j.source),"%s",source?source:"");
+        for(size_t i=0;i<x.size();i++)
+            if(x[i]!=0.0){ j.idx.push_back((int32_t)i); j.val.push_back(x[i]); }
+        {
+            std::lock_guard<std::mutex> g(mu_);
+            if(q_.size()>=cap_){ q_.pop_front(); dropped_++; }
+            q_.push_back(std::move(j));
+        }
+        cv_.notify_one();
+    }
+
+    // blocks until every queued incumbent is on disk
+    void flush(){
+        std::unique_lock<std::mutex> g(mu_);
+        idle_cv_.wait(g,[&]{ return q_.empty() && !busy_; });
+    }
+
+    size_t written() const { std::lock_guard<std::mutex> g(mu_); return written_; }
+    size_t dropped() const { std::lock_guard<std::mutex> g(mu_); return dropped_; }
+    size_t failed()  const { std::lock_guard<std::mutex> g(mu_); return failed_; }
+
+private:
+    struct Job {
+        int id=0;
+        int64_t n=0;
+        double obj=0, ts=0;
+        char source[32]={0};
+        std::vector<int32_t> idx;
+        std::vector<double> val;
+    };
+
+    void loop(){
+        while(true){
+            Job j;
+            {
+                std::unique_lock<std::mutex> g(mu_);
+                cv_.wait(g,[&]{ return stop_ || !q_.empty(); });
+                if(q_.empty()){ idle_cv_.notify_all(); return; }
+                j=std::move(q_.front());
+                q_.pop_front();
+                busy_=true;
+            }
+            bool ok=write(j);
+            {
+                std::lock_guard<std::mutex> g(mu_);
+                busy_=false;
+                if(ok) written_++; else failed_++;
+            }
+            idle_cv_.notify_all();
+        }
+    }
+
+    bool write(const Job& j){
+        PROF_SCOPE("sol.write");
+        std::string base=dir_+"/incumbent_"+std::to_string(j.id);
+        bool ok=true;
+        if(fmt_&BIN)
+            ok&=msol_write_sparse((base+".msol").c_str(),j.n,(int64_t)j.idx.size(),
+                                  j.idx.data(),j.val.data(),j.obj,j.ts,j.source)==0;
+        if(fmt_&TEXT) ok&=write_text(base+".sol",j);
+        return ok;
+    }
+
+    // text export, every column; formatted with to_chars into one buffer
+    static bool write_text(const std::string& path, const Job& j){
+        std::string buf;
+        buf.reserve((size_t)j.n*12+64);
+        char num[64];
+        auto put=[&](double v){
+            auto r=std::to_chars(num,num+sizeof(num),v);
+            buf.append(num,r.ptr);
+        };
+        buf+="obj: "; put(j.obj); buf+='\n';
+        size_t k=0;
+        for(int64_t i=0;i<j.n;i++){
+            double v=0;
+            if(k<j.idx.size() && j.idx[k]==i) v=j.val[k++];
+            buf+='x';
+            auto r=std::to_chars(num,num+sizeof(num),(long long)i);
+            buf.append(num,r.ptr);
+            buf+=' ';
+            put(v);
+            buf+='\n';
+        }
+        char tmp[4096];
+        FILE* f=msol_open_tmp(path.c_str(),tmp,sizeof(tmp));
+        if(!f) return false;
+        fwrite(buf.data(),1,buf.size(),f);
+        return msol_commit(f,tmp,path.c_str())==0;
+    }
+
+    std::string dir_;
+    int fmt_;
+    size_t cap_;
+    std::deque<Job> q_;
+    mutable std::mutex mu_;
+    std::condition_variable cv_, idle_cv_;
+    bool stop_=false, busy_=false;
+    size_t written_=0, dropped_=0, failed_=0;
+    std::thread th_;
+};
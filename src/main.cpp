@@ -8,6 +8,8 @@
 #include <thrust/device_vector.h>
 #include <thrust/host_vector.h>
 
+#include "../mip_core.hpp"
+
 // Error checking macro
 #define cudaCheckError(ans) { gpuAssert((ans), __FILE__, __LINE__); }
 inline void gpuAssert(cudaError_t code, const char *file, int line, bool abort=true) {
@@ -17,40 +19,39 @@ inline void gpuAssert(cudaError_t code, const char *file, int line, bool abort=t
   }
 }
 
-struct MoveResult {
-   int mutex;       // 0 = unlocked, 1 = locked
-   float delta_obj;
-   int i;           
-   int j;           
-   int di;          
-   int dj;          
-};
+// mutex: 0 = unlocked, 1 = locked; delta starts as the acceptance bound
+using MoveResult = mip_core::MoveResult<float>;
 
 /**
-* CUDA Kernel: Hybrid Sparse/Dense 2-Opt Check
-* - One Block per pair (i, j)
+* CUDA Kernel: Sparse 2-Opt Check
+* - One Block per candidate pair (i, j) from d_pair_i/d_pair_j: only
+*   variables that share a row (see pair_gen.hpp), not the full n x n grid.
 * - Uses Sparse CSC to iterate active constraints.
-* - Uses Dense Matrix for O(1) coefficient lookups and intersection checks.
+* - Looks up a shared row's coefficient in the other column by binary search
+*   over its sorted CSC row list (mip_core::column_find), so no dense m x n
+*   copy of A is needed and memory stays O(nnz).
 * - Uses CCCL atomic_ref for efficient global synchronization (wait/notify).
 */
 __global__ void find_2opt_move_kernel_hybrid(
    const int* __restrict__ d_A_col_ptr,
    const int* __restrict__ d_A_row_ind,
    const float* __restrict__ d_A_val,
-   const float* __restrict__ d_A_dense, // PRECOMPUTED DENSE LOOKUP
    const float* __restrict__ d_b,
    const float* __restrict__ d_c,
    const float* __restrict__ d_x,
    const float* __restrict__ d_lb,
    const float* __restrict__ d_ub,
    const float* __restrict__ d_activity,
-   int num_vars,
+   const int* __restrict__ d_pair_i,
+   const int* __restrict__ d_pair_j,
+   int num_pairs,
    MoveResult* d_result
 ) {
-   int i = blockIdx.x;
-   int j = blockIdx.y;
+   int p = blockIdx.x;
+   if (p >= num_pairs) return;
 
-   if (i >= num_vars || j >= num_vars || i >= j) return;
+   int i = d_pair_i[p];
+   int j = d_pair_j[p];
 
    // Get Column Ranges from Global Memory
    int start_i = d_A_col_ptr[i];
@@ -79,7 +80,7 @@ __global__ void find_2opt_move_kernel_hybrid(
            float potential_delta = c_i * (float)di + c_j * (float)dj;
            
            // Optimization: Read strictly to avoid overhead, but careful with stale data
-           if (potential_delta >= d_result->delta_obj) continue;
+           if (potential_delta >= d_result->delta) continue;
 
            // --- Feasibility Check ---
            if (threadIdx.x == 0) s_feasible = 1;
@@ -97,7 +98,8 @@ __global__ void find_2opt_move_kernel_hybrid(
                    
                    float val_j = 0.0f;
                    if (dj != 0) {
-                       val_j = d_A_dense[row * num_vars + j];
+                       int q = mip_core::column_find(d_A_col_ptr, d_A_row_ind, j, row);
+                       if (q >= 0) val_j = d_A_val[q];
                    }
 
                    float change = val_i * (float)di + val_j * (float)dj;
@@ -121,10 +123,9 @@ __global__ void find_2opt_move_kernel_hybrid(
                    // coalesced read!
                    int row = d_A_row_ind[idx];
 
-                   if (di != 0) {
-                       if (d_A_dense[row * num_vars + i] != 0.0f) {
-                           continue;
-                       }
+                   // shared rows were checked with column i
+                   if (di != 0 && mip_core::column_find(d_A_col_ptr, d_A_row_ind, i, row) >= 0) {
+                       continue;
                    }
                    // coalesced read
                    float val_j = d_A_val[idx];
@@ -141,7 +142,7 @@ __global__ void find_2opt_move_kernel_hybrid(
            if (threadIdx.x == 0 && s_feasible) {
                // --- CRITICAL SECTION WITH CCCL ATOMIC_REF ---
                // 1. Check if we are potentially better (Optimization: avoids unnecessary locking)
-               if (potential_delta < d_result->delta_obj) {
+               if (potential_delta < d_result->delta) {
                    // Create an atomic reference to the mutex in global memory
                    // Scope: Device (visible to all threads on the GPU)
                    cuda::atomic_ref lock(d_result->mutex);
@@ -155,8 +156,8 @@ __global__ void find_2opt_move_kernel_hybrid(
                    }
 
                    // 3. Double-Check inside lock (Required because another thread might have updated while we waited)
-                   if (potential_delta < d_result->delta_obj) {
-                       d_result->delta_obj = potential_delta;
+                   if (potential_delta < d_result->delta) {
+                       d_result->delta = potential_delta;
                        d_result->i = i;
                        d_result->j = j;
                        d_result->di = di;
@@ -176,22 +177,62 @@ __global__ void find_2opt_move_kernel_hybrid(
    }
 }
 
+// CPU reference: the same moves and row test as the kernel, with the rows
+// of (i, j) checked by a merge walk over both columns
+// (mip_core::pair_move_feasible) instead of coefficient lookups.
+MoveResult find_2opt_move_cpu(
+   const std::vector<int>& col_ptr,
+   const std::vector<int>& row_ind,
+   const std::vector<float>& val,
+   const std::vector<float>& b,
+   const std::vector<float>& c,
+   const std::vector<float>& x,
+   const std::vector<float>& lb,
+   const std::vector<float>& ub,
+   const std::vector<float>& activity,
+   const std::vector<int>& pair_i,
+   const std::vector<int>& pair_j
+) {
+   std::vector<float> rlo(b.size(), -FLT_MAX);   // rows are a x <= b
+   MoveResult best = {0, 0.0f, -1, -1, 0, 0};
+   for (size_t p = 0; p < pair_i.size(); ++p) {
+       int i = pair_i[p], j = pair_j[p];
+       for (int di = -1; di <= 1; ++di) {
+           float new_xi = x[i] + (float)di;
+           if (new_xi < lb[i] || new_xi > ub[i]) continue;
+           for (int dj = -1; dj <= 1; ++dj) {
+               if (di == 0 && dj == 0) continue;
+               float new_xj = x[j] + (float)dj;
+               if (new_xj < lb[j] || new_xj > ub[j]) continue;
+               float delta = c[i] * (float)di + c[j] * (float)dj;
+               if (delta >= best.delta) continue;
+               if (!mip_core::pair_move_feasible(col_ptr.data(), row_ind.data(), val.data(),
+                                                 activity.data(), rlo.data(), b.data(),
+                                                 i, di, j, dj, 1e-5f)) continue;
+               best = {0, delta, i, j, di, dj};
+           }
+       }
+   }
+   return best;
+}
+
 int main() {
    const int N = 3; // Vars
    const int M = 2; // Constraints
 
-   std::vector h_c = {-2.0f, -3.0f, -4.0f};
-   std::vector h_b = {4.0f, 3.0f};
+   std::vector<float> h_c = {-2.0f, -3.0f, -4.0f};
+   std::vector<float> h_b = {4.0f, 3.0f};
    
-   std::vector h_A_dense = {
+   // input only; the device works on the CSC
+   std::vector<float> h_A_dense = {
        3.0f, 2.0f, 1.0f,
        1.0f, 1.0f, 2.0f 
    };
 
    // --- Convert to CSC ---
-   std::vector h_col_ptr = {0};
-   std::vector h_row_ind;
-   std::vector h_val;
+   std::vector<int> h_col_ptr = {0};
+   std::vector<int> h_row_ind;
+   std::vector<float> h_val;
 
    for (int col = 0; col < N; ++col) {
        for (int row = 0; row < M; ++row) {
@@ -204,46 +245,69 @@ int main() {
        h_col_ptr.push_back(h_row_ind.size());
    }
 
-   std::vector h_lb(N, 0.0f);
-   std::vector h_ub(N, 1.0f);
-   std::vector h_x = {0.0f, 0.0f, 0.0f};
+   std::vector<float> h_lb(N, 0.0f);
+   std::vector<float> h_ub(N, 1.0f);
+   std::vector<float> h_x = {0.0f, 0.0f, 0.0f};
    
-   std::vector h_activity(M, 0.0f);
-   for(int k=0; k d_A_col_ptr = h_col_ptr;
-   thrust::device_vector d_A_row_ind = h_row_ind;
-   thrust::device_vector d_A_val = h_val;
-   thrust::device_vector d_A_dense = h_A_dense;
-   
-   thrust::device_vector d_b = h_b;
-   thrust::device_vector d_c = h_c;
-   thrust::device_vector d_x = h_x;
-   thrust::device_vector d_lb = h_lb;
-   thrust::device_vector d_ub = h_ub;
-   thrust::device_vector d_activity = h_activity;
+   std::vector<float> h_activity(M, 0.0f);
+   for (int col = 0; col < N; ++col) {
+       for (int k = h_col_ptr[col]; k < h_col_ptr[col+1]; ++k) {
+           h_activity[h_row_ind[k]] += h_val[k] * h_x[col];
+       }
+   }
+
+   thrust::device_vector<int>   d_A_col_ptr = h_col_ptr;
+   thrust::device_vector<int>   d_A_row_ind = h_row_ind;
+   thrust::device_vector<float> d_A_val     = h_val;
+
+   thrust::device_vector<float> d_b  = h_b;
+   thrust::device_vector<float> d_c  = h_c;
+   thrust::device_vector<float> d_x  = h_x;
+   thrust::device_vector<float> d_lb = h_lb;
+   thrust::device_vector<float> d_ub = h_ub;
+   thrust::device_vector<float> d_activity = h_activity;
 
    // Initialize result on device
    MoveResult initial_res = {0, 0.0f, -1, -1, 0, 0};
-   thrust::device_vector d_result(1, initial_res);
+   thrust::device_vector<MoveResult> d_result(1, initial_res);
 
    // --- Launch Kernel ---
-   dim3 grid(N, N);
+   // Candidate pairs: (i < j) sharing at least one row
+   std::vector<int> h_pair_i, h_pair_j;
+   for (int i = 0; i < N; ++i) {
+       for (int j = i + 1; j < N; ++j) {
+           for (int k = h_col_ptr[i]; k < h_col_ptr[i+1]; ++k) {
+               if (mip_core::column_find(h_col_ptr.data(), h_row_ind.data(), j, h_row_ind[k]) >= 0) {
+                   h_pair_i.push_back(i);
+                   h_pair_j.push_back(j);
+                   break;
+               }
+           }
+       }
+   }
+   thrust::device_vector<int> d_pair_i = h_pair_i;
+   thrust::device_vector<int> d_pair_j = h_pair_j;
+   int num_pairs = (int)h_pair_i.size();
+
+   dim3 grid(num_pairs);
    int threadsPerBlock = 128;
 
-   std::cout << "Launching Hybrid Kernel using Thrust..." << std::endl;
+   std::cout << "Launching Sparse Kernel using Thrust..." << std::endl;
    
    // Use raw_pointer_cast to extract pointers for the kernel
-   find_2opt_move_kernel_hybrid<<>>(
+   find_2opt_move_kernel_hybrid<<<grid, threadsPerBlock>>>(
        thrust::raw_pointer_cast(d_A_col_ptr.data()),
        thrust::raw_pointer_cast(d_A_row_ind.data()),
        thrust::raw_pointer_cast(d_A_val.data()),
-       thrust::raw_pointer_cast(d_A_dense.data()),
        thrust::raw_pointer_cast(d_b.data()),
        thrust::raw_pointer_cast(d_c.data()),
        thrust::raw_pointer_cast(d_x.data()),
        thrust::raw_pointer_cast(d_lb.data()),
        thrust::raw_pointer_cast(d_ub.data()),
        thrust::raw_pointer_cast(d_activity.data()),
-       N,
+       thrust::raw_pointer_cast(d_pair_i.data()),
+       thrust::raw_pointer_cast(d_pair_j.data()),
+       num_pairs,
        thrust::raw_pointer_cast(d_result.data())
    );
    cudaCheckError(cudaDeviceSynchronize());
@@ -252,10 +316,65 @@ int main() {
    MoveResult best_move;
    cudaMemcpy(&best_move, thrust::raw_pointer_cast(d_result.data()), sizeof(MoveResult), cudaMemcpyDeviceToHost);
 
+   MoveResult ref = find_2opt_move_cpu(h_col_ptr, h_row_ind, h_val, h_b, h_c, h_x, h_lb, h_ub,
+                                       h_activity, h_pair_i, h_pair_j);
+
    std::cout << "Best Move Found:\n";
-   std::cout << "  Obj Delta: " << best_move.delta_obj << "\n";
+   std::cout << "  Obj Delta: " << best_move.delta << " (CPU reference: " << ref.delta << ")\n";
+   if (best_move.delta != ref.delta) std::cout << "  MISMATCH with the CPU reference\n";
+
+   // --- The same pairs on the mip_core back ends (+-1 moves of both only) ---
+   // CSR as well, for the activities below
+   std::vector<int> h_row_ptr = {0};
+   std::vector<int> h_col_ind;
+   std::vector<float> h_rval;
+   for (int row = 0; row < M; ++row) {
+       for (int col = 0; col < N; ++col) {
+           float val = h_A_dense[row * N + col];
+           if (abs(val) > 1e-6) {
+               h_col_ind.push_back(col);
+               h_rval.push_back(val);
+           }
+       }
+       h_row_ptr.push_back(h_col_ind.size());
+   }
+   std::vector<float> h_rlo(M, -FLT_MAX);   // rows are a x <= b
+
+   mip_core::CoreModel<float, int> hm;
+   hm.m = M; hm.n = N;
+   hm.csr = {M, h_row_ptr.data(), h_col_ind.data(), h_rval.data()};
+   hm.csc = {N, h_col_ptr.data(), h_row_ind.data(), h_val.data()};
+   hm.obj = h_c.data(); hm.lb = h_lb.data(); hm.ub = h_ub.data();
+   hm.rlo = h_rlo.data(); hm.rhi = h_b.data();
+
+   thrust::device_vector<int>   d_row_ptr = h_row_ptr;
+   thrust::device_vector<int>   d_col_ind = h_col_ind;
+   thrust::device_vector<float> d_rval    = h_rval;
+   thrust::device_vector<float> d_rlo     = h_rlo;
+
+   mip_core::CoreModel<float, int> dm = hm;   // same sizes, device arrays
+   dm.csr = {M, thrust::raw_pointer_cast(d_row_ptr.data()), thrust::raw_pointer_cast(d_col_ind.data()),
+             thrust::raw_pointer_cast(d_rval.data())};
+   dm.csc = {N, thrust::raw_pointer_cast(d_A_col_ptr.data()), thrust::raw_pointer_cast(d_A_row_ind.data()),
+             thrust::raw_pointer_cast(d_A_val.data())};
+   dm.obj = thrust::raw_pointer_cast(d_c.data());
+   dm.lb = thrust::raw_pointer_cast(d_lb.data()); dm.ub = thrust::raw_pointer_cast(d_ub.data());
+   dm.rlo = thrust::raw_pointer_cast(d_rlo.data()); dm.rhi = thrust::raw_pointer_cast(d_b.data());
+
+   MoveResult core_cpu = initial_res;
+   mip_core::best_pair_move<mip_core::Backend::CPU>(hm, h_x.data(), h_activity.data(),
+       h_pair_i.data(), h_pair_j.data(), num_pairs, 1e-5f, &core_cpu);
+   thrust::device_vector<MoveResult> d_core(1, initial_res);
+   mip_core::best_pair_move<mip_core::Backend::CUDA>(dm, thrust::raw_pointer_cast(d_x.data()),
+       thrust::raw_pointer_cast(d_activity.data()), thrust::raw_pointer_cast(d_pair_i.data()),
+       thrust::raw_pointer_cast(d_pair_j.data()), num_pairs, 1e-5f, thrust::raw_pointer_cast(d_core.data()));
+   cudaCheckError(cudaDeviceSynchronize());
+   MoveResult core_gpu;
+   cudaMemcpy(&core_gpu, thrust::raw_pointer_cast(d_core.data()), sizeof(MoveResult), cudaMemcpyDeviceToHost);
+   std::cout << "  Core pair move delta: " << core_gpu.delta << " (CPU back end: " << core_cpu.delta << ")\n";
+   if (core_gpu.delta != core_cpu.delta) std::cout << "  MISMATCH between the core back ends\n";
    
-   if (best_move.delta_obj < 0) {
+   if (best_move.delta < 0) {
        std::cout << "  Apply: x[" << best_move.i << "] += " << best_move.di << "\n";
        std::cout << "  Apply: x[" << best_move.j << "] += " << best_move.dj << "\n";
        h_x[best_move.i] += best_move.di;
@@ -263,7 +382,19 @@ int main() {
        std::cout << "  New Solution Vector: [ ";
        for(float val : h_x) std::cout << val << " ";
        std::cout << "]" << std::endl;
+
+       // the new point against every row, on the device and on the host
+       thrust::device_vector<float> d_x_new = h_x;
+       thrust::device_vector<float> d_act_new(M);
+       mip_core::activities<mip_core::Backend::CUDA>(dm, thrust::raw_pointer_cast(d_x_new.data()),
+                                                     thrust::raw_pointer_cast(d_act_new.data()));
+       mip_core::FeasResult<float> fr = mip_core::check_feasibility<mip_core::Backend::CUDA>(
+           dm, thrust::raw_pointer_cast(d_act_new.data()), 1e-5f);
+       std::vector<float> h_act_new(M);
+       mip_core::activities<mip_core::Backend::CPU>(hm, h_x.data(), h_act_new.data());
+       mip_core::FeasResult<float> fr_cpu = mip_core::check_feasibility<mip_core::Backend::CPU>(hm, h_act_new.data(), 1e-5f);
+       std::cout << "  Rows violated: " << fr.violated << " (CPU back end: " << fr_cpu.violated << ")\n";
    }
 
    return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,139 @@
+// two_opt.hpp  (header-only; the MIP_HD functions also compile for CUDA)
+//
+// 2-opt move evaluation on the sparse structure. A move shifts x_i by di
+// and x_j by dj (di,dj in {-1,0,1}) and costs obj_i*di + obj_j*dj. Its
+// feasibility is decided by a merge walk over the sorted CSC row lists
+// of i and j, so only rows the move actually touches are checked
+// (mip_core.hpp; these are its double / int instances).
+//
+//   two_opt_sweep       neighbour pairs from pair_gen.hpp (shared rows)
+//   best_combined_1opt  single moves, and pairs with disjoint supports
+//                       built from the best independent single moves
+//
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "mip_core.hpp"
+#include "mip_problem.hpp"
+#include "pair_gen.hpp"
+
+struct TwoOptMove {
+    int i=-1, j=-1, di=0, dj=0;     // j=-1, dj=0 for a single move
+    double delta=0;
+};
+
+// double / int instances of the mip_core.hpp primitives
+MIP_HD inline bool step_in_bounds(const double* x, const double* lb, const double* ub, int j, int d){
+    return mip_core::step_in_bounds(x,lb,ub,j,d);
+}
+
+// Rows touched by (i,di),(j,dj) stay within [rlo-tol, rhi+tol].
+MIP_HD inline bool pair_move_feasible(const int* cp, const int* ri, const double* cv,
+                                      const double* act, const double* rlo, const double* rhi,
+                                      int i, int di, int j, int dj, double tol){
+    return mip_core::pair_move_feasible(cp,ri,cv,act,rlo,rhi,i,di,j,dj,tol);
+}
+
+// Sink keeping the single best move; scan functions only offer moves
+// with delta < bound(). TopMoves (two_opt_batch.hpp) keeps the K best.
+struct BestMoveSink {
+    TwoOptMove& best;
+    double bound() const { return best.delta; }
+    void offer(const TwoOptMove& mv){ best=mv; }
+};
+
+// Scans the neighbour pairs of columns [c0,c1) of C.order into sink.
+template<class Sink>
+inline void two_opt_scan_range(const MipView& P, const double* x, const double* act,
+                               const CandidatePairs& C, int c0, int c1,
+                               Sink& sink, double tol=1e-8){
+    for(int t=c0;t<c1;t++){
+        int i=C.order[t];
+        double ci0=P.obj[i];
+        for(int64_t q=C.ptr[i];q<C.ptr[i+1];q++){
+            int j=C.nb[q];
+            double cj0=P.obj[j];
+            for(int di=-1;di<=1;di+=2){
+                if(!step_in_bounds(x,P.lb,P.ub,i,di)) continue;
+                for(int dj=-1;dj<=1;dj+=2){
+                    double d=ci0*di+cj0*dj;
+                    if(d>=sink.bound()) continue;
+                    if(!step_in_bounds(x,P.lb,P.ub,j,dj)) continue;
+                    if(!pair_move_feasible(P.cp,P.ri,P.cv,act,P.rlo,P.rhi,i,di,j,dj,tol)) continue;
+                    TwoOptMove mv; mv.i=i; mv.j=j; mv.di=di; mv.dj=dj; mv.delta=d;
+                    sink.offer(mv);
+                }
+            }
+        }
+    }
+}
+
+// Scans all feasible improving single moves into sink.
+template<class Sink>
+inline void one_opt_scan(const MipView& P, const double* x, const double* act,
+                         const CandidatePairs& C, Sink& sink, double tol=1e-8){
+    for(int j=0;j<P.n;j++){
+        if(!C.movable[j]) continue;
+        for(int d=-1;d<=1;d+=2){
+            double delta=P.obj[j]*d;
+            if(delta>=sink.bound()) continue;
+            if(!step_in_bounds(x,P.lb,P.ub,j,d)) continue;
+            if(!pair_move_feasible(P.cp,P.ri,P.cv,act,P.rlo,P.rhi,j,d,-1,0,tol)) continue;
+            TwoOptMove mv; mv.i=j; mv.di=d; mv.delta=delta;
+            sink.offer(mv);
+        }
+    }
+}
+
+// Best move over the neighbour pairs of columns [c0,c1) of C.order.
+inline void two_opt_sweep_range(const MipView& P, const double* x, const double* act,
+                                const CandidatePairs& C, int c0, int c1,
+                                TwoOptMove& best, double tol=1e-8){
+    BestMoveSink sink{best};
+    two_opt_scan_range(P,x,act,C,c0,c1,sink,tol);
+}
+
+inline void two_opt_sweep(const MipView& P, const double* x, const double* act,
+                          const CandidatePairs& C, TwoOptMove& best, double tol=1e-8){
+    two_opt_sweep_range(P,x,act,C,0,(int)C.order.size(),best,tol);
+}
+
+// Best single move, and best pair of single moves with disjoint row
+// supports among the K most improving ones. Disjoint supports make the
+// combined move feasible whenever both parts are.
+inline void best_combined_1opt(const MipView& P, const double* x, const double* act,
+                               const CandidatePairs& C, TwoOptMove& best,
+                               double tol=1e-8, int K=32){
+    struct AllSink {
+        std::vector<TwoOptMove> v;
+        double bound() const { return 0; }
+        void offer(const TwoOptMove& mv){ v.push_back(mv); }
+    } all;
+    one_opt_scan(P,x,act,C,all,tol);
+    std::vector<TwoOptMove>& one=all.v;
+    if(one.empty()) return;
+    auto by_delta=[](const TwoOptMove& a, const TwoOptMove& b){ return a.delta<b.delta; };
+    int k=std::min<int>(K,(int)one.size());
+    std::partial_sort(one.begin(),one.begin()+k,one.end(),by_delta);
+    if(one[0].delta<best.delta) best=one[0];
+
+    std::vector<int> stamp(P.m,-1);
+    for(int a=0;a<k;a++){
+        int i=one[a].i;
+        for(int q=P.cp[i];q<P.cp[i+1];q++) stamp[P.ri[q]]=a;
+        for(int b=a+1;b<k;b++){
+            int j=one[b].i;
+            double d=one[a].delta+one[b].delta;
+            if(j==i || d>=best.delta) continue;
+            bool disjoint=true;
+            for(int q=P.cp[j];q<P.cp[j+1] && disjoint;q++) disjoint=stamp[P.ri[q]]!=a;
+            if(!disjoint) continue;
+            best.i=i; best.di=one[a].di;
+            best.j=j; best.dj=one[b].di;
+            best.delta=d;
+        }
+    }
+}
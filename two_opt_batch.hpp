@@ -0,0 +1,135 @@
+// two_opt_batch.hpp  (header-only)
+//
+// Batched 2-opt: instead of applying only the best move of a sweep, keep
+// the K best improving moves (TopMoves), pick a greedy independent subset
+// in order of delta and apply all of it at once.
+//
+// Two moves are independent when they share no variable and no row. Each
+// candidate is feasible on its own at the current activities, and with
+// disjoint row supports no row is changed by more than one of them, so the
+// combined move is feasible too. apply_batch() still checks the
+// incrementally kept violation count afterwards and falls back to the
+// single best move if tolerance effects ever break that.
+//
+//   TopMoves top(K);
+//   two_opt_scan_range(P, x, act, C, 0, nc, top);   // or E.best_moves()
+//   select_independent(P, top.sorted(), batch, row_stamp, col_stamp);
+//   apply_batch(ls, batch);
+//
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "ls_state.hpp"
+#include "mip_problem.hpp"
+#include "prof.hpp"
+#include "two_opt.hpp"
+
+// K best moves seen so far, kept as a max-heap on delta so bound() (the
+// K-th best delta, 0 until K moves are held) prunes like BestMoveSink.
+struct TopMoves {
+    int K=1;
+    std::vector<TwoOptMove> h;
+
+    explicit TopMoves(int k=1) : K(k<1?1:k) {}
+
+    static bool worse(const TwoOptMove& a, const TwoOptMove& b){ return a.delta<b.delta; }
+
+    void clear(){ h.clear(); }
+    double bound() const { return (int)h.size()<K ? 0.0 : h.front().delta; }
+
+    void offer(const TwoOptMove& mv){
+        if((int)h.size()<K){
+            h.push_back(mv);
+            std::push_heap(h.begin(),h.end(),worse);
+        } else if(mv.delta<h.front().delta){
+            std::pop_heap(h.begin(),h.end(),worse);
+            h.back()=mv;
+            std::push_heap(h.begin(),h.end(),worse);
+        }
+    }
+
+    void merge(const TopMoves& o){ for(const TwoOptMove& mv:o.h) offer(mv); }
+
+    // moves in ascending delta (most improving first)
+    std::vector<TwoOptMove> sorted() const {
+        std::vector<TwoOptMove> v(h);
+        std::sort(v.begin(),v.end(),worse);
+        return v;
+    }
+};
+
+// Greedy independent set over cand: moves are visited by delta, ties by
+// support size (a short column blocks fewer others), and a move is taken
+// when none of its variables and none of its rows is used by a taken move.
+// row_stamp / col_stamp are scratch of size m / n; they are reset on return.
+inline void select_independent(const MipView& P, const std::vector<TwoOptMove>& cand,
+                               std::vector<TwoOptMove>& out,
+                               std::vector<unsigned char>& row_stamp,
+                               std::vector<unsigned char>& col_stamp){
+    PROF_SCOPE("2opt.select");
+    out.clear();
+    row_stamp.resize(P.m,0);
+    col_stamp.resize(P.n,0);
+    auto free_col=[&](int j){
+        if(col_stamp[j]) return false;
+        for(int q=P.cp[j];q<P.cp[j+1];q++) if(row_stamp[P.ri[q]]) return false;
+        return true;
+    };
+    auto take_col=[&](int j){
+        col_stamp[j]=1;
+        for(int q=P.cp[j];q<P.cp[j+1];q++) row_stamp[P.ri[q]]=1;
+    };
+    auto support=[&](const TwoOptMove& mv){
+        int s=P.cp[mv.i+1]-P.cp[mv.i];
+        if(mv.j>=0) s+=P.cp[mv.j+1]-P.cp[mv.j];
+        return s;
+    };
+    std::vector<int> ord(cand.size());
+    for(size_t t=0;t<cand.size();t++) ord[t]=(int)t;
+    std::sort(ord.begin(),ord.end(),[&](int a, int b){
+        if(cand[a].delta!=cand[b].delta) return cand[a].delta<cand[b].delta;
+        return support(cand[a])<support(cand[b]);
+    });
+    for(int t:ord){
+        const TwoOptMove& mv=cand[t];
+        if(mv.i<0 || mv.delta>=0) continue;
+        if(!free_col(mv.i) || (mv.j>=0 && !free_col(mv.j))) continue;
+        take_col(mv.i);
+        if(mv.j>=0) take_col(mv.j);
+        out.push_back(mv);
+    }
+    for(const TwoOptMove& mv:out){
+        for(int k=0;k<2;k++){
+            int j=k?mv.j:mv.i;
+            if(j<0) continue;
+            col_stamp[j]=0;
+            for(int q=P.cp[j];q<P.cp[j+1];q++) row_stamp[P.ri[q]]=0;
+        }
+    }
+}
+
+inline void apply_move(LsState& ls, const TwoOptMove& mv, int sign=1){
+    ls.move(mv.i,sign*mv.di);
+    if(mv.j>=0) ls.move(mv.j,sign*mv.dj);
+}
+
+// Applies the batch (as returned by select_independent) and returns the number of moves kept.
+// If the combined point violates a row that was satisfied before, all but
+// the first (most improving) move are undone.
+inline int apply_batch(LsState& ls, const std::vector<TwoOptMove>& batch){
+    if(batch.empty()) return 0;
+    PROF_SCOPE("2opt.apply");
+    int before=ls.n_viol;
+    for(const TwoOptMove& mv:batch) apply_move(ls,mv);
+    if(ls.n_viol<=before){
+        PROF_COUNT("2opt.applied",batch.size());
+        return (int)batch.size();
+    }
+    for(size_t t=batch.size();t-->1;) apply_move(ls,batch[t],-1);
+    PROF_COUNT("2opt.applied",1);
+    PROF_COUNT("2opt.undone",batch.size()-1);
+    return 1;
+}
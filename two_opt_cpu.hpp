@@ -0,0 +1,249 @@
+// two_opt_cpu.hpp  (header-only, link with -lpthread)
+//
+// Multithreaded CPU 2-opt engine, same move semantics as MoveResult in
+// fp2opt (i, j, di, dj, delta). The candidate pairs (pair_gen.hpp) are cut
+// into chunks of about equal pair count; every worker owns a contiguous
+// range of chunks, takes from its front and, when empty, steals half of
+// another worker's remaining range from the back. Each range is one packed
+// 64-bit word updated by CAS, so owner and thieves never lock.
+//
+// Workers keep their own best move and publish its exact delta in their
+// slot; the global best is a packed 64-bit key (order-preserving bits of
+// float(delta) << 32 | worker id) lowered by CAS. Pruning reads the exact
+// delta back from the key's slot, and the final move is the smallest
+// exact delta over all slots, so float ties never decide. No mutex is
+// taken on the hot path.
+//
+//   TwoOptEngine E(P, C);                 // threads = hardware_concurrency
+//   TwoOptMove mv = E.best_move(x, act);  // mv.i < 0: no improving move
+//   E.best_moves(x, act, K, cand);        // batch candidates (two_opt_batch.hpp)
+//
+// In batch mode each worker keeps its own K best and prunes against its
+// own K-th; the per-worker lists are merged after the sweep.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "mip_problem.hpp"
+#include "pair_gen.hpp"
+#include "prof.hpp"
+#include "two_opt.hpp"
+#include "two_opt_batch.hpp"
+
+class TwoOptEngine {
+public:
+    TwoOptEngine(const MipView& P, const CandidatePairs& C, int threads=0, double tol=1e-8)
+        : P_(P), C_(C), tol_(tol) {
+        if(threads<=0) threads=(int)std::thread::hardware_concurrency();
+        if(threads<1) threads=1;
+        nth_=threads;
+        build_chunks();
+        slots_.reset(new Slot[nth_]);
+        for(int t=1;t<nth_;t++) pool_.emplace_back(&TwoOptEngine::worker,this,t);
+    }
+
+    ~TwoOptEngine(){
+        {
+            std::lock_guard<std::mutex> g(mu_);
+            stop_=true;
+            gen_++;
+        }
+        cv_.notify_all();
+        for(auto& t:pool_) t.join();
+    }
+
+    TwoOptEngine(const TwoOptEngine&) = delete;
+    TwoOptEngine& operator=(const TwoOptEngine&) = delete;
+
+    int threads() const { return nth_; }
+
+    // Best improving move for the current point (x, act), including single
+    // moves and non-interacting pairs (best_combined_1opt).
+    TwoOptMove best_move(const double* x, const double* act){
+        sweep(x,act,1);
+        TwoOptMove best;
+        for(int t=0;t<nth_;t++)
+            if(slots_[t].best.i>=0 && slots_[t].best.delta<best.delta) best=slots_[t].best;
+        best_combined_1opt(P_,x,act,C_,best,tol_);
+        return best;
+    }
+
+    // Batch candidates in ascending delta: the K best pair moves and every
+    // improving single move. Single moves are kept without a cap because
+    // on tightly coupled rows the K best of them often all conflict, while
+    // scanning them costs only O(nnz).
+    void best_moves(const double* x, const double* act, int K, std::vector<TwoOptMove>& cand){
+        sweep(x,act,K);
+        TopMoves top(K);
+        for(int t=0;t<nth_;t++) top.merge(slots_[t].top);
+        PROF_SCOPE("2opt.one_opt");
+        TopMoves one(2*P_.n);
+        one_opt_scan(P_,x,act,C_,one,tol_);
+        one.merge(top);
+        cand=one.sorted();
+    }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> range{0};     // begin | end << 32
+        TwoOptMove best;
+        std::atomic<double> pub{0};         // exact best.delta, for pruning
+        TopMoves top;                       // batch mode (k_ > 1)
+    };
+
+    static constexpr uint64_t NO_MOVE=~0ull;
+    static constexpr int64_t CHUNK_PAIRS=4096;
+
+    static uint64_t pack_range(uint32_t b, uint32_t e){ return (uint64_t)b | ((uint64_t)e<<32); }
+
+    // order-preserving map of float to uint32 (smaller delta -> smaller key)
+    static uint32_t fkey(double d){
+        float f=(float)d;
+        uint32_t u; memcpy(&u,&f,4);
+        return (u&0x80000000u) ? ~u : (u|0x80000000u);
+    }
+
+    // one parallel sweep over all chunks; k>1 collects the k best per worker
+    void sweep(const double* x, const double* act, int k){
+        PROF_SCOPE("2opt.sweep");
+        PROF_COUNT("2opt.pairs_scanned",C_.num_pairs());
+        x_=x; act_=act; k_=k;
+        int nc=(int)chunk_ptr_.size()-1;
+        for(int t=0;t<nth_;t++){
+            uint32_t b=(uint32_t)((int64_t)nc*t/nth_), e=(uint32_t)((int64_t)nc*(t+1)/nth_);
+            slots_[t].range.store(pack_range(b,e),std::memory_order_relaxed);
+            slots_[t].best=TwoOptMove();
+            slots_[t].pub.store(0,std::memory_order_relaxed);
+            slots_[t].top=TopMoves(k);
+        }
+        key_.store(NO_MOVE,std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> g(mu_);
+            running_=nth_-1;
+            gen_++;
+        }
+        cv_.notify_all();
+        run(0);
+        {
+            std::unique_lock<std::mutex> g(mu_);
+            done_cv_.wait(g,[&]{ return running_==0; });
+        }
+    }
+
+    void build_chunks(){
+        chunk_ptr_.assign(1,0);
+        int64_t acc=0;
+        int nc=(int)C_.order.size();
+        for(int t=0;t<nc;t++){
+            acc+=C_.degree(C_.order[t]);
+            if(acc>=CHUNK_PAIRS){ chunk_ptr_.push_back(t+1); acc=0; }
+        }
+        if(chunk_ptr_.back()!=nc) chunk_ptr_.push_back(nc);
+    }
+
+    // owner: take one chunk from the front
+    bool take(int t, uint32_t& c){
+        uint64_t r=slots_[t].range.load(std::memory_order_acquire);
+        while(true){
+            uint32_t b=(uint32_t)r, e=(uint32_t)(r>>32);
+            if(b>=e) return false;
+            if(slots_[t].range.compare_exchange_weak(r,pack_range(b+1,e))){ c=b; return true; }
+        }
+    }
+
+    // thief: move the back half of victim v's range into slot t
+    bool steal(int t, int v){
+        uint64_t r=slots_[v].range.load(std::memory_order_acquire);
+        while(true){
+            uint32_t b=(uint32_t)r, e=(uint32_t)(r>>32);
+            if(b>=e) return false;
+            uint32_t mid=b+(e-b)/2;
+            if(slots_[v].range.compare_exchange_weak(r,pack_range(b,mid))){
+                slots_[t].range.store(pack_range(mid,e),std::memory_order_release);
+                return true;
+            }
+        }
+    }
+
+    void publish(int t){
+        const TwoOptMove& mv=slots_[t].best;
+        if(mv.i<0) return;
+        slots_[t].pub.store(mv.delta,std::memory_order_release);
+        uint64_t mine=((uint64_t)fkey(mv.delta)<<32) | (uint32_t)t;
+        uint64_t cur=key_.load(std::memory_order_relaxed);
+        while(mine<cur && !key_.compare_exchange_weak(cur,mine)){}
+    }
+
+    void run(int t){
+        TwoOptMove& best=slots_[t].best;
+        while(true){
+            uint32_t c;
+            if(!take(t,c)){
+                bool stolen=false;
+                for(int k=1;k<nth_ && !stolen;k++) stolen=steal(t,(t+k)%nth_);
+                if(!stolen) break;
+                continue;
+            }
+            if(k_>1){
+                two_opt_scan_range(P_,x_,act_,C_,chunk_ptr_[c],chunk_ptr_[c+1],slots_[t].top,tol_);
+                continue;
+            }
+            // prune against the global best found so far
+            TwoOptMove local;
+            local.delta=best.delta;
+            uint64_t g=key_.load(std::memory_order_acquire);
+            if(g!=NO_MOVE){
+                double gd=slots_[(int)(g&0xffffffffu)].pub.load(std::memory_order_acquire);
+                if(gd<local.delta) local.delta=gd;   // kept only if delta < gd
+            }
+            two_opt_sweep_range(P_,x_,act_,C_,chunk_ptr_[c],chunk_ptr_[c+1],local,tol_);
+            if(local.i>=0 && local.delta<best.delta){ best=local; publish(t); }
+        }
+    }
+
+    void worker(int t){
+        uint64_t seen=0;
+        while(true){
+            {
+                std::unique_lock<std::mutex> g(mu_);
+                cv_.wait(g,[&]{ return gen_!=seen; });
+                seen=gen_;
+                if(stop_) return;
+            }
+            run(t);
+            {
+                std::lock_guard<std::mutex> g(mu_);
+                if(--running_==0) done_cv_.notify_one();
+            }
+        }
+    }
+
+    const MipView& P_;
+    const CandidatePairs& C_;
+    double tol_;
+    int nth_=1;
+    std::vector<int> chunk_ptr_;
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<uint64_t> key_{NO_MOVE};
+
+    const double* x_=nullptr;
+    const double* act_=nullptr;
+    int k_=1;
+
+    std::vector<std::thread> pool_;
+    std::mutex mu_;
+    std::condition_variable cv_, done_cv_;
+    uint64_t gen_=0;
+    int running_=0;
+    bool stop_=false;
+};
@@ -4,6 +4,8 @@
 #include <zlib.h>
 #include <string>
 
+#include "mip_cache.hpp"
+
 namespace fs = std::filesystem;
 
 // Changed parameter name to 'inputPath' to avoid conflict with 'gzFile' type
@@ -54,6 +56,16 @@ int main() {
         if (entry.path().extension() == ".gz") {
             std::cout << "Decompressing: " << entry.path().filename() << std::endl;
             decompressGzip(entry.path().string());
+
+            // Binary cache next to the instance, picked up by MipInstance::open
+            MipProblem P;
+            std::string err;
+            std::string cache = mip_cache_path(entry.path().string());
+            if (!read_mps(entry.path().string(), P, &err)) {
+                std::cerr << "Failed to parse: " << entry.path() << " (" << err << ")" << std::endl;
+            } else if (!write_mip_cache(cache, P)) {
+                std::cerr << "Failed to write: " << cache << std::endl;
+            }
         }
     }
 